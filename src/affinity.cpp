@@ -0,0 +1,192 @@
+#include "affinity.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+int CpuTopology::cpuCount() const
+{
+    int count = 0;
+    for (size_t n = 0; n < nodes.size(); n++)
+        count += (int)nodes[n].size();
+    return count;
+}
+
+#ifdef __linux__
+// Parses a sysfs list such as "0-3,8-11" (CPUs or nodes)
+static std::vector<int> parseCpuList(const std::string& text)
+{
+    std::vector<int> cpus;
+    const char* p = text.c_str();
+    while (*p)
+    {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p)
+            break;
+        long last = first;
+        p = end;
+        if (*p == '-')
+        {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; cpu++)
+            cpus.push_back((int)cpu);
+        if (*p == ',')
+            p++;
+    }
+    return cpus;
+}
+#endif
+
+CpuTopology detectCpuTopology()
+{
+    CpuTopology topology;
+
+#ifdef _WIN32
+    DWORD_PTR processMask = 0, systemMask = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+    ULONG highest = 0;
+    if (GetNumaHighestNodeNumber(&highest))
+    {
+        for (ULONG node = 0; node <= highest; node++)
+        {
+            ULONGLONG nodeMask = 0;
+            if (!GetNumaNodeProcessorMask((UCHAR)node, &nodeMask))
+                continue;
+            std::vector<int> cpus;
+            for (int cpu = 0; cpu < 64; cpu++)
+            {
+                if ((nodeMask & processMask) >> cpu & 1)
+                    cpus.push_back(cpu);
+            }
+            if (!cpus.empty())
+                topology.nodes.push_back(cpus);
+        }
+    }
+#elif defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool haveAllowed = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    std::string online;
+    std::ifstream onlineFile("/sys/devices/system/node/online");
+    std::getline(onlineFile, online);
+    std::vector<int> nodeIds = parseCpuList(online);
+    for (size_t n = 0; n < nodeIds.size(); n++)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodeIds[n]);
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+
+        std::vector<int> cpus;
+        std::vector<int> listed = parseCpuList(line);
+        for (size_t i = 0; i < listed.size(); i++)
+        {
+            if (!haveAllowed || (listed[i] < CPU_SETSIZE && CPU_ISSET(listed[i], &allowed)))
+                cpus.push_back(listed[i]);
+        }
+        if (!cpus.empty())
+            topology.nodes.push_back(cpus);
+    }
+
+    if (topology.nodes.empty() && haveAllowed)
+    {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+                cpus.push_back(cpu);
+        }
+        topology.nodes.push_back(cpus);
+    }
+#endif
+
+    if (topology.nodes.empty())
+    {
+        std::vector<int> cpus;
+        int count = (int)std::thread::hardware_concurrency();
+        for (int cpu = 0; cpu < (count > 0 ? count : 1); cpu++)
+            cpus.push_back(cpu);
+        topology.nodes.push_back(cpus);
+    }
+    return topology;
+}
+
+bool parsePinMode(const std::string& text, PinMode& mode)
+{
+    if (text == "none")
+        mode = PIN_NONE;
+    else if (text == "compact")
+        mode = PIN_COMPACT;
+    else if (text == "spread")
+        mode = PIN_SPREAD;
+    else
+        return false;
+    return true;
+}
+
+const char* pinModeName(PinMode mode)
+{
+    switch (mode)
+    {
+    case PIN_COMPACT: return "compact";
+    case PIN_SPREAD: return "spread";
+    default: return "none";
+    }
+}
+
+std::vector<CpuPlacement> planCpuPlacement(const CpuTopology& topology, int workers, PinMode mode)
+{
+    std::vector<CpuPlacement> plan;
+    int nodeCount = (int)topology.nodes.size();
+    for (int i = 0; i < workers; i++)
+    {
+        CpuPlacement placement = {-1, 0};
+        if (mode == PIN_SPREAD)
+        {
+            placement.node = i % nodeCount;
+            const std::vector<int>& cpus = topology.nodes[placement.node];
+            placement.cpu = cpus[(i / nodeCount) % cpus.size()];
+        }
+        else if (mode == PIN_COMPACT)
+        {
+            int index = i % topology.cpuCount();
+            while (index >= (int)topology.nodes[placement.node].size())
+                index -= (int)topology.nodes[placement.node++].size();
+            placement.cpu = topology.nodes[placement.node][index];
+        }
+        plan.push_back(placement);
+    }
+    return plan;
+}
+
+bool pinCurrentThread(int cpu)
+{
+#ifdef _WIN32
+    if (cpu < 0 || cpu >= 64)
+        return false;
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
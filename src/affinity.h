@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Which logical CPUs this process may run on, grouped by NUMA node. Read
+// from /sys/devices/system/node on Linux and the NUMA API on Windows; one
+// node holding every allowed CPU elsewhere.
+struct CpuTopology
+{
+    std::vector<std::vector<int> > nodes;
+
+    int cpuCount() const;
+};
+
+CpuTopology detectCpuTopology();
+
+// How pool workers are placed on CPUs
+enum PinMode
+{
+    PIN_NONE,      // leave it to the OS scheduler
+    PIN_COMPACT,   // fill node 0 first, then node 1, ...; keeps a small pool on one socket
+    PIN_SPREAD     // round-robin over the nodes; uses every socket's memory bandwidth
+};
+
+// Parses none|compact|spread. Returns false on anything else.
+bool parsePinMode(const std::string& text, PinMode& mode);
+
+const char* pinModeName(PinMode mode);
+
+struct CpuPlacement
+{
+    int cpu;       // -1 when not pinned
+    int node;      // NUMA node the worker's memory should come from
+};
+
+// CPU and node for each of `workers` workers. With more workers than CPUs
+// the plan wraps around.
+std::vector<CpuPlacement> planCpuPlacement(const CpuTopology& topology, int workers, PinMode mode);
+
+// Restricts the calling thread to one CPU. Returns false where pinning is
+// unsupported or refused. Memory the thread touches first afterwards is
+// then allocated on its node by the OS's first-touch policy.
+bool pinCurrentThread(int cpu);
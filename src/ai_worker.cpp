@@ -0,0 +1,120 @@
+#include "ai_worker.h"
+
+// Up to this many empty cells, pondering covers every reply of the human
+const int PONDER_ALL_REPLIES_CELLS = 16;
+
+AiWorker::AiWorker(const HypergraphRules& rules)
+    : rules(rules), search(rules, 18), stopSearch(false)
+{
+}
+
+AiWorker::~AiWorker()
+{
+    shutdown();
+}
+
+void AiWorker::start()
+{
+    if (!thread.joinable())
+        thread = std::thread(&AiWorker::run, this);
+}
+
+void AiWorker::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+        hasRequest = false;
+        stopSearch = true;
+    }
+    wake.notify_one();
+    if (thread.joinable())
+        thread.join();
+}
+
+void AiWorker::requestMove(const HypergraphState& state, unsigned int generation, const SearchLimits& limits)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request = state;
+        requestGeneration = generation;
+        requestLimits = limits;
+        requestIsPonder = false;
+        hasRequest = true;
+        stopSearch = true;
+    }
+    wake.notify_one();
+}
+
+void AiWorker::ponder(const HypergraphState& state)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request = state;
+        requestLimits = SearchLimits();
+        requestIsPonder = true;
+        hasRequest = true;
+        stopSearch = true;
+    }
+    wake.notify_one();
+}
+
+void AiWorker::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    hasRequest = false;
+    stopSearch = true;
+}
+
+bool AiWorker::pollMove(AiMove& move)
+{
+    return results.pop(move);
+}
+
+void AiWorker::run()
+{
+    HypergraphState state;
+    SearchLimits limits;
+    unsigned int generation;
+    bool pondering;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return hasRequest || quitting; });
+            if (quitting)
+                return;
+
+            state = request;
+            limits = requestLimits;
+            generation = requestGeneration;
+            pondering = requestIsPonder;
+            hasRequest = false;
+            stopSearch = false;
+        }
+
+        limits.stop = &stopSearch;
+
+        if (pondering)
+        {
+            // On big boards, guess the reply from the last search's PV
+            int emptyCells = rules.graph.cellCount - state.moveCount;
+            if (emptyCells > PONDER_ALL_REPLIES_CELLS && lastPv.size() >= 2 && state.cells[lastPv[1]] == EMPTY_CELL)
+                rules.makeMove(state, lastPv[1]);
+            if (!rules.isTerminal(state))
+                search.search(state, limits);
+            continue;
+        }
+
+        SearchResult result = search.search(state, limits);
+        lastPv = result.pv;
+
+        // A cancelled or replaced search has nothing to report
+        if (stopSearch || result.bestMove < 0)
+            continue;
+
+        AiMove move = {result.bestMove, generation};
+        results.push(move);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "search.h"
+#include "spsc_queue.h"
+
+struct AiMove
+{
+    int move;
+    unsigned int generation;   // game the move was computed for
+};
+
+// Runs the engine on a background thread so the window keeps rendering and
+// handling input while the AI thinks. Requests go in under a mutex (the
+// worker sleeps between them); chosen moves come back through a lock-free
+// queue that the render loop drains at the top of each frame.
+//
+// Between moves the worker ponders: it keeps searching while the human
+// decides, and the transposition table it fills is reused by the next real
+// search, which then mostly answers from the table.
+class AiWorker
+{
+public:
+    explicit AiWorker(const HypergraphRules& rules);
+    ~AiWorker();
+
+    void start();
+    void shutdown();
+
+    // Starts searching a copy of `state`, replacing any search in progress
+    void requestMove(const HypergraphState& state, unsigned int generation, const SearchLimits& limits);
+
+    // Searches while the opponent is to move in `state`, until the next
+    // request. Small boards search every reply; larger ones search the reply
+    // predicted by the last principal variation.
+    void ponder(const HypergraphState& state);
+
+    // Stops the current search without producing a move
+    void cancel();
+
+    // Main thread only: returns the next finished move, if any
+    bool pollMove(AiMove& move);
+
+private:
+    void run();
+
+    const HypergraphRules& rules;
+    AlphaBetaSearch<HypergraphRules> search;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool hasRequest = false;
+    bool requestIsPonder = false;
+    bool quitting = false;
+    HypergraphState request;
+    unsigned int requestGeneration = 0;
+    SearchLimits requestLimits;
+
+    std::atomic<bool> stopSearch;
+    std::vector<int> lastPv;     // worker thread only
+    SpscQueue<AiMove, 16> results;
+};
@@ -0,0 +1,112 @@
+#include "analysis_worker.h"
+
+AnalysisWorker::AnalysisWorker(const HypergraphRules& rules)
+    : rules(rules), search(rules, 18), stopSearch(false)
+{
+}
+
+AnalysisWorker::~AnalysisWorker()
+{
+    shutdown();
+}
+
+void AnalysisWorker::start()
+{
+    if (!thread.joinable())
+        thread = std::thread(&AnalysisWorker::run, this);
+}
+
+void AnalysisWorker::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+        hasRequest = false;
+        stopSearch = true;
+    }
+    wake.notify_one();
+    if (thread.joinable())
+        thread.join();
+}
+
+void AnalysisWorker::analyze(const HypergraphState& state, unsigned int generation)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request = state;
+        requestGeneration = generation;
+        hasRequest = true;
+        stopSearch = true;
+    }
+    wake.notify_one();
+}
+
+void AnalysisWorker::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    hasRequest = false;
+    stopSearch = true;
+}
+
+bool AnalysisWorker::pollValues(CellValues& values)
+{
+    std::unique_lock<std::mutex> lock(resultMutex, std::try_to_lock);
+    if (!lock.owns_lock() || !latestIsNew)
+        return false;
+    values = latest;
+    latestIsNew = false;
+    return true;
+}
+
+void AnalysisWorker::publish(const CellValues& values)
+{
+    std::lock_guard<std::mutex> lock(resultMutex);
+    latest = values;
+    latestIsNew = true;
+}
+
+void AnalysisWorker::run()
+{
+    HypergraphState state;
+    CellValues values;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return hasRequest || quitting; });
+            if (quitting)
+                return;
+
+            state = request;
+            values.generation = requestGeneration;
+            hasRequest = false;
+            stopSearch = false;
+        }
+
+        int cellCount = rules.graph.cellCount;
+        values.depth = 0;
+        values.scores.assign(cellCount, 0);
+        values.valid.assign(cellCount, 0);
+        if (rules.isTerminal(state))
+        {
+            publish(values);
+            continue;
+        }
+
+        // Every root move is a line, so all cells get exact scores from one
+        // search per depth
+        SearchLimits limits;
+        limits.stop = &stopSearch;
+        search.searchMultiPv(state, limits, cellCount - state.moveCount, [&](const MultiPvResult& result)
+        {
+            values.depth = result.depth;
+            for (size_t i = 0; i < result.lines.size(); i++)
+            {
+                values.scores[result.lines[i].move] = result.lines[i].score;
+                values.valid[result.lines[i].move] = 1;
+            }
+            publish(values);
+        });
+    }
+}
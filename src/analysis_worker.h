@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "search.h"
+
+// Value of every move in one position, for the analysis overlay
+struct CellValues
+{
+    unsigned int generation = 0;     // position the values belong to
+    int depth = 0;                   // search depth they were computed at
+    std::vector<int> scores;         // per cell, from the side to move
+    std::vector<uint8_t> valid;      // 1 for cells that were empty and scored
+};
+
+// Scores every empty cell of a position on a background thread with a
+// multi-PV search covering all root moves, so the overlay fills in quickly
+// and then sharpens. Each finished depth replaces the published values; the
+// render loop picks them up with pollValues, which never waits for the worker.
+class AnalysisWorker
+{
+public:
+    explicit AnalysisWorker(const HypergraphRules& rules);
+    ~AnalysisWorker();
+
+    void start();
+    void shutdown();
+
+    // Starts analysing a copy of `state`, replacing the current analysis
+    void analyze(const HypergraphState& state, unsigned int generation);
+
+    // Stops the current analysis
+    void cancel();
+
+    // Main thread only: copies the latest values if they changed since the
+    // last call. Returns false if there is nothing new or the worker is
+    // publishing at this moment.
+    bool pollValues(CellValues& values);
+
+private:
+    void run();
+    void publish(const CellValues& values);
+
+    const HypergraphRules& rules;
+    AlphaBetaSearch<HypergraphRules> search;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool hasRequest = false;
+    bool quitting = false;
+    HypergraphState request;
+    unsigned int requestGeneration = 0;
+
+    std::atomic<bool> stopSearch;
+
+    std::mutex resultMutex;
+    CellValues latest;
+    bool latestIsNew = false;
+};
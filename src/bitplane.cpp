@@ -0,0 +1,153 @@
+#include "bitplane.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "options.h"
+#include "random.h"
+#include "simd_kernels.h"
+
+void bitPlanesReset(BitPlanes& planes, int rows, int cols)
+{
+    planes.rows = rows;
+    planes.cols = cols;
+    uint64_t rowMask = cols >= 64 ? ~0ULL : (1ULL << cols) - 1;
+    for (int row = 0; row < BITPLANE_MAX_SIZE + BITPLANE_PADDING; row++)
+    {
+        planes.stones[0][row] = 0;
+        planes.stones[1][row] = 0;
+        planes.onBoard[row] = row < rows ? rowMask : 0;
+    }
+}
+
+void bitPlanesFromState(BitPlanes& planes, const HypergraphState& state, int rows, int cols)
+{
+    bitPlanesReset(planes, rows, cols);
+    for (int row = 0; row < rows; row++)
+    {
+        for (int col = 0; col < cols; col++)
+        {
+            int player = state.cells[row * cols + col];
+            if (player != EMPTY_CELL)
+                bitPlanesSet(planes, player, row, col);
+        }
+    }
+}
+
+bool bitPlanesHasWin(const BitPlanes& planes, int player, int k)
+{
+    if (k < 1 || k > BITPLANE_MAX_SIZE)
+        return false;
+    return simdKernels().bitPlanesHasWin(planes, player, k);
+}
+
+int bitPlanesCountThreats(const BitPlanes& planes, int player, int k)
+{
+    if (k < 1 || k > BITPLANE_MAX_SIZE)
+        return 0;
+    return simdKernels().bitPlanesCountThreats(planes, player, k);
+}
+
+const char* bitPlanesKernelName()
+{
+    return simdLevelName(simdKernels().level);
+}
+
+// Reference answers straight from the line list
+static void scanLines(const Hypergraph& graph, const std::vector<int8_t>& cells, int player, bool& win, int& threats)
+{
+    win = false;
+    threats = 0;
+    for (int line = 0; line < graph.lineCount; line++)
+    {
+        int own = 0, other = 0;
+        for (int i = graph.lineStart[line]; i < graph.lineStart[line + 1]; i++)
+        {
+            int cell = cells[graph.lineCells[i]];
+            if (cell == player)
+                own++;
+            else if (cell != EMPTY_CELL)
+                other++;
+        }
+        int length = lineLength(graph, line);
+        if (own == length)
+            win = true;
+        if (other == 0 && own == length - 1)
+            threats++;
+    }
+}
+
+int runScanCommand(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, 2, options))
+        return 1;
+
+    int rows = (int)getIntOption(options, "rows", 64);
+    int cols = (int)getIntOption(options, "cols", rows);
+    int k = (int)getIntOption(options, "k", 5);
+    int positions = (int)getIntOption(options, "positions", 1000);
+    int fill = (int)getIntOption(options, "fill", 30);
+    uint64_t seed = (uint64_t)getIntOption(options, "seed", 1);
+    if (rows < 1 || cols < 1 || rows > BITPLANE_MAX_SIZE || cols > BITPLANE_MAX_SIZE || k < 1 || positions < 1)
+    {
+        std::cout << "scan supports grids of at most 64x64" << std::endl;
+        return 1;
+    }
+
+    Hypergraph graph = makeGridGame(rows, cols, k);
+    std::vector<BitPlanes> boards(positions);
+    std::vector<std::vector<int8_t> > cells(positions);
+    for (int p = 0; p < positions; p++)
+    {
+        // Position p is random stream (seed, p); each cell is taken with
+        // probability fill%, by either player
+        Xoshiro128 rng;
+        seedRandom(rng, seed, p);
+        bitPlanesReset(boards[p], rows, cols);
+        cells[p].assign(graph.cellCount, EMPTY_CELL);
+        for (int cell = 0; cell < graph.cellCount; cell++)
+        {
+            if (randomBelow(rng, 100) >= fill)
+                continue;
+            int player = randomBelow(rng, 2);
+            cells[p][cell] = (int8_t)player;
+            bitPlanesSet(boards[p], player, cell / cols, cell % cols);
+        }
+    }
+
+    // Verification pass against the line list
+    int mismatches = 0;
+    for (int p = 0; p < positions; p++)
+    {
+        for (int player = 0; player < 2; player++)
+        {
+            bool win;
+            int threats;
+            scanLines(graph, cells[p], player, win, threats);
+            if (win != bitPlanesHasWin(boards[p], player, k) || threats != bitPlanesCountThreats(boards[p], player, k))
+                mismatches++;
+        }
+    }
+
+    // Timed pass: every position, both players, win check and threat count
+    const int REPEATS = 10;
+    long long checksum = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < REPEATS; repeat++)
+    {
+        for (int p = 0; p < positions; p++)
+        {
+            for (int player = 0; player < 2; player++)
+                checksum += bitPlanesHasWin(boards[p], player, k) + bitPlanesCountThreats(boards[p], player, k);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long long scans = (long long)positions * 2 * REPEATS;
+
+    std::cout << "board: " << rows << "x" << cols << ", k = " << k << " (kernel: " << bitPlanesKernelName() << ")" << std::endl;
+    std::cout << "positions: " << positions << ", mismatches against line list: " << mismatches << std::endl;
+    std::cout << "scans: " << scans << " (checksum " << checksum << "), time: " << (long long)(seconds * 1000)
+        << " ms, scans/s: " << (long long)(seconds > 0 ? scans / seconds : 0) << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
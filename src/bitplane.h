@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include "rules.h"
+
+// Row-major bit planes for k-in-a-row on grids of up to 64x64: one 64-bit
+// word per row, bit c for column c, one plane per player. A direction is
+// scanned for whole rows at once: k-1 shifts and ANDs leave a bit set at
+// every cell that starts a full window. Rows are processed several at a
+// time with SIMD, so a full-board scan is a few hundred instructions.
+
+const int BITPLANE_MAX_SIZE = 64;
+
+// Extra zero rows past the last one, so SIMD loads of a group of rows that
+// runs off the board stay inside the arrays
+const int BITPLANE_PADDING = 8;
+
+struct BitPlanes
+{
+    int rows = 0;
+    int cols = 0;
+    alignas(32) uint64_t stones[2][BITPLANE_MAX_SIZE + BITPLANE_PADDING];
+    alignas(32) uint64_t onBoard[BITPLANE_MAX_SIZE + BITPLANE_PADDING];
+};
+
+void bitPlanesReset(BitPlanes& planes, int rows, int cols);
+
+inline void bitPlanesSet(BitPlanes& planes, int player, int row, int col)
+{
+    planes.stones[player][row] |= 1ULL << col;
+}
+
+inline void bitPlanesClear(BitPlanes& planes, int player, int row, int col)
+{
+    planes.stones[player][row] &= ~(1ULL << col);
+}
+
+// Loads a position of a grid game (cell = row * cols + col)
+void bitPlanesFromState(BitPlanes& planes, const HypergraphState& state, int rows, int cols);
+
+// True if `player` has k in a row horizontally, vertically or diagonally
+bool bitPlanesHasWin(const BitPlanes& planes, int player, int k);
+
+// Number of windows of k cells (in all four directions) holding k-1 stones
+// of `player` and one empty cell: the moves that would win on the spot,
+// counted once per line they complete.
+int bitPlanesCountThreats(const BitPlanes& planes, int player, int k);
+
+// Name of the kernel the functions above use ("avx2", ...)
+const char* bitPlanesKernelName();
+
+// `tictactoe-cli scan ...`: checks the scans against the hypergraph rules on
+// random positions and measures full-board scans per second
+int runScanCommand(int argc, char** argv);
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include "bitplane.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Bit-plane scans written once against a small set of operations on 64-bit
+// words and instantiated for one row at a time (plain integers) or two, four
+// or eight rows at a time (SSE4.2, AVX2, AVX-512), each in the translation
+// unit built for that instruction set (see simd_kernels.h), hence the internal
+// linkage. A group of rows always starts at the same anchor row in every
+// direction, so no lane ever needs data from another lane.
+
+namespace {
+
+struct ScalarWords
+{
+    typedef uint64_t Reg;
+    static const int WORDS = 1;
+
+    static Reg zero() { return 0; }
+    static Reg load(const uint64_t* p) { return *p; }
+    static void store(uint64_t* p, Reg a) { *p = a; }
+    static Reg bitAnd(Reg a, Reg b) { return a & b; }
+    static Reg bitXor(Reg a, Reg b) { return a ^ b; }
+    static Reg andNot(Reg a, Reg b) { return a & ~b; }
+    static Reg shiftRight(Reg a, int n) { return a >> n; }
+    static Reg shiftLeft(Reg a, int n) { return a << n; }
+    static bool allZero(Reg a) { return a == 0; }
+    static int popcount(Reg a) { return __builtin_popcountll(a); }
+};
+
+#if defined(__SSE4_2__) && defined(__POPCNT__)
+struct Sse42Words
+{
+    typedef __m128i Reg;
+    static const int WORDS = 2;
+
+    static Reg zero() { return _mm_setzero_si128(); }
+    static Reg load(const uint64_t* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static void store(uint64_t* p, Reg a) { _mm_storeu_si128((__m128i*)p, a); }
+    static Reg bitAnd(Reg a, Reg b) { return _mm_and_si128(a, b); }
+    static Reg bitXor(Reg a, Reg b) { return _mm_xor_si128(a, b); }
+    static Reg andNot(Reg a, Reg b) { return _mm_andnot_si128(b, a); }
+    static Reg shiftRight(Reg a, int n) { return _mm_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+    static Reg shiftLeft(Reg a, int n) { return _mm_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+    static bool allZero(Reg a) { return _mm_testz_si128(a, a) != 0; }
+    static int popcount(Reg a)
+    {
+        return (int)(_mm_popcnt_u64((uint64_t)_mm_extract_epi64(a, 0)) + _mm_popcnt_u64((uint64_t)_mm_extract_epi64(a, 1)));
+    }
+};
+#endif
+
+#if defined(__AVX2__)
+struct Avx2Words
+{
+    typedef __m256i Reg;
+    static const int WORDS = 4;
+
+    static Reg zero() { return _mm256_setzero_si256(); }
+    static Reg load(const uint64_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static void store(uint64_t* p, Reg a) { _mm256_storeu_si256((__m256i*)p, a); }
+    static Reg bitAnd(Reg a, Reg b) { return _mm256_and_si256(a, b); }
+    static Reg bitXor(Reg a, Reg b) { return _mm256_xor_si256(a, b); }
+    static Reg andNot(Reg a, Reg b) { return _mm256_andnot_si256(b, a); }
+    static Reg shiftRight(Reg a, int n) { return _mm256_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+    static Reg shiftLeft(Reg a, int n) { return _mm256_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+    static bool allZero(Reg a) { return _mm256_testz_si256(a, a) != 0; }
+    static int popcount(Reg a)
+    {
+        return __builtin_popcountll((uint64_t)_mm256_extract_epi64(a, 0)) + __builtin_popcountll((uint64_t)_mm256_extract_epi64(a, 1))
+            + __builtin_popcountll((uint64_t)_mm256_extract_epi64(a, 2)) + __builtin_popcountll((uint64_t)_mm256_extract_epi64(a, 3));
+    }
+};
+#endif
+
+#if defined(__AVX512F__)
+struct Avx512Words
+{
+    typedef __m512i Reg;
+    static const int WORDS = 8;
+
+    static Reg zero() { return _mm512_setzero_si512(); }
+    static Reg load(const uint64_t* p) { return _mm512_loadu_si512(p); }
+    static void store(uint64_t* p, Reg a) { _mm512_storeu_si512(p, a); }
+    static Reg bitAnd(Reg a, Reg b) { return _mm512_and_si512(a, b); }
+    static Reg bitXor(Reg a, Reg b) { return _mm512_xor_si512(a, b); }
+    static Reg andNot(Reg a, Reg b) { return _mm512_andnot_si512(b, a); }
+    static Reg shiftRight(Reg a, int n) { return _mm512_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+    static Reg shiftLeft(Reg a, int n) { return _mm512_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+    static bool allZero(Reg a) { return _mm512_test_epi64_mask(a, a) == 0; }
+    static int popcount(Reg a)
+    {
+        // No VPOPCNTQ without AVX512_VPOPCNTDQ
+        alignas(64) uint64_t words[8];
+        _mm512_store_si512(words, a);
+        int count = 0;
+        for (int i = 0; i < 8; i++)
+            count += __builtin_popcountll(words[i]);
+        return count;
+    }
+};
+#endif
+
+// The four directions as (row step, column step). Cell i of the window
+// anchored at (row, col) is (row + i * rowStep, col + i * colStep).
+static const int BITPLANE_DIRECTIONS[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+
+// Cell i of the windows anchored at rows [row, row + WORDS), aligned so that
+// bit c belongs to the window anchored at column c
+template<class V>
+inline typename V::Reg windowCell(const uint64_t* plane, int row, int i, int rowStep, int colStep)
+{
+    typename V::Reg value = V::load(plane + row + i * rowStep);
+    if (colStep > 0)
+        return V::shiftRight(value, i);
+    if (colStep < 0)
+        return V::shiftLeft(value, i);
+    return value;
+}
+
+// Rows past the board and bits past the last column are zero, so windows
+// that leave the board can never come out full and need no masking
+template<class V>
+bool hasWinWords(const BitPlanes& planes, int player, int k)
+{
+    typedef typename V::Reg Reg;
+    const uint64_t* stones = planes.stones[player];
+
+    for (int d = 0; d < 4; d++)
+    {
+        int rowStep = BITPLANE_DIRECTIONS[d][0], colStep = BITPLANE_DIRECTIONS[d][1];
+        int anchors = planes.rows - (k - 1) * rowStep;
+
+        for (int row = 0; row < anchors; row += V::WORDS)
+        {
+            Reg full = windowCell<V>(stones, row, 0, rowStep, colStep);
+            for (int i = 1; i < k && !V::allZero(full); i++)
+                full = V::bitAnd(full, windowCell<V>(stones, row, i, rowStep, colStep));
+            if (!V::allZero(full))
+                return true;
+        }
+    }
+    return false;
+}
+
+// A window is a threat when none of its cells is off the board or taken by
+// the opponent and exactly k-1 of them hold the player's stones. The stones
+// are counted per bit with a bit-sliced ripple counter.
+template<class V>
+int countThreatsWords(const BitPlanes& planes, int player, int k)
+{
+    typedef typename V::Reg Reg;
+    const int MAX_COUNTER_BITS = 7;   // counts up to 127 >= 64
+
+    const uint64_t* stones = planes.stones[player];
+    alignas(32) uint64_t open[BITPLANE_MAX_SIZE + BITPLANE_PADDING];
+    for (int row = 0; row < BITPLANE_MAX_SIZE + BITPLANE_PADDING; row++)
+        open[row] = planes.onBoard[row] & ~planes.stones[1 - player][row];
+
+    int counterBits = 1;
+    while ((1 << counterBits) <= k)
+        counterBits++;
+    int target = k - 1;
+
+    // With k = 1 all four directions give the same one-cell windows
+    int directions = k == 1 ? 1 : 4;
+    int threats = 0;
+    for (int d = 0; d < directions; d++)
+    {
+        int rowStep = BITPLANE_DIRECTIONS[d][0], colStep = BITPLANE_DIRECTIONS[d][1];
+        int anchors = planes.rows - (k - 1) * rowStep;
+
+        for (int row = 0; row < anchors; row += V::WORDS)
+        {
+            Reg free = windowCell<V>(open, row, 0, rowStep, colStep);
+            Reg counter[MAX_COUNTER_BITS];
+            counter[0] = windowCell<V>(stones, row, 0, rowStep, colStep);
+            for (int b = 1; b < counterBits; b++)
+                counter[b] = V::zero();
+
+            for (int i = 1; i < k; i++)
+            {
+                free = V::bitAnd(free, windowCell<V>(open, row, i, rowStep, colStep));
+                Reg carry = windowCell<V>(stones, row, i, rowStep, colStep);
+                for (int b = 0; b < counterBits && !V::allZero(carry); b++)
+                {
+                    Reg next = V::bitAnd(counter[b], carry);
+                    counter[b] = V::bitXor(counter[b], carry);
+                    carry = next;
+                }
+            }
+
+            // Keep the bits whose counter equals k-1
+            Reg match = free;
+            for (int b = 0; b < counterBits; b++)
+                match = (target >> b) & 1 ? V::bitAnd(match, counter[b]) : V::andNot(match, counter[b]);
+            threats += V::popcount(match);
+        }
+    }
+    return threats;
+}
+
+}
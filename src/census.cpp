@@ -0,0 +1,384 @@
+#include "census.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <thread>
+#include "options.h"
+#include "packed_state.h"
+
+static uint64_t mixKey(uint64_t key)
+{
+    key ^= key >> 31;
+    key *= 0x7fb5d329728ea185ULL;
+    key ^= key >> 27;
+    key *= 0x81dadef4bc2dd44dULL;
+    key ^= key >> 33;
+    return key;
+}
+
+ConcurrentKeySet::ConcurrentKeySet(int sizeLog2, TaskPool* pool, bool narrowKeys)
+    : mask(((uint64_t)1 << sizeLog2) - 1), count(0)
+{
+    if (narrowKeys)
+        narrowSlots.reset(new std::atomic<uint32_t>[(size_t)1 << sizeLog2]);
+    else
+        slots.reset(new std::atomic<uint64_t>[(size_t)1 << sizeLog2]);
+
+    const uint64_t chunk = 1 << 16;
+    uint64_t chunks = (mask + chunk) / chunk;
+    auto clear = [&](uint64_t c)
+    {
+        for (uint64_t i = c * chunk; i <= mask && i < (c + 1) * chunk; i++)
+        {
+            if (narrowKeys)
+                narrowSlots[i].store(0, std::memory_order_relaxed);
+            else
+                slots[i].store(0, std::memory_order_relaxed);
+        }
+    };
+    if (pool)
+        parallelFor(*pool, 0, chunks, 1, clear);
+    else
+    {
+        for (uint64_t c = 0; c < chunks; c++)
+            clear(c);
+    }
+}
+
+// Returns 1 if inserted, 0 if already present, -1 if the table is full
+template <typename Slot>
+static int insertKey(std::atomic<Slot>* slots, uint64_t mask, uint64_t key)
+{
+    Slot stored = (Slot)(key + 1);
+    uint64_t index = mixKey(key) & mask;
+
+    for (uint64_t probe = 0; probe <= mask; probe++, index = (index + 1) & mask)
+    {
+        Slot current = slots[index].load(std::memory_order_relaxed);
+        if (current == stored)
+            return 0;
+        if (current == 0)
+        {
+            if (slots[index].compare_exchange_strong(current, stored, std::memory_order_relaxed))
+                return 1;
+            // Another thread claimed the slot first; it may have stored our key
+            if (current == stored)
+                return 0;
+        }
+    }
+    return -1;
+}
+
+bool ConcurrentKeySet::insert(uint64_t key)
+{
+    int inserted = narrowSlots ? insertKey(narrowSlots.get(), mask, key) : insertKey(slots.get(), mask, key);
+    if (inserted != 1)
+        return false;
+    count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+BoardSymmetries findSymmetries(const Hypergraph& graph, bool enabled)
+{
+    int rows = graph.rows;
+    int cols = graph.cols;
+
+    std::set<std::vector<int>> lines;
+    for (int l = 0; l < graph.lineCount; l++)
+    {
+        std::vector<int> cells(graph.lineCells.begin() + graph.lineStart[l], graph.lineCells.begin() + graph.lineStart[l + 1]);
+        std::sort(cells.begin(), cells.end());
+        lines.insert(cells);
+    }
+
+    BoardSymmetries symmetries;
+    int transforms = enabled ? 8 : 1;
+
+    for (int t = 0; t < transforms; t++)
+    {
+        // Transforms 4..7 swap rows and columns, which needs a square board
+        if (t >= 4 && rows != cols)
+            continue;
+
+        std::vector<int> permutation(graph.cellCount);
+        for (int r = 0; r < rows; r++)
+        {
+            for (int c = 0; c < cols; c++)
+            {
+                int rr = (t & 1) ? rows - 1 - r : r;
+                int cc = (t & 2) ? cols - 1 - c : c;
+                permutation[r * cols + c] = (t & 4) ? cc * cols + rr : rr * cols + cc;
+            }
+        }
+
+        bool preservesLines = true;
+        for (std::set<std::vector<int>>::const_iterator it = lines.begin(); it != lines.end() && preservesLines; ++it)
+        {
+            std::vector<int> image;
+            for (size_t i = 0; i < it->size(); i++)
+                image.push_back(permutation[(*it)[i]]);
+            std::sort(image.begin(), image.end());
+            preservesLines = lines.count(image) != 0;
+        }
+        if (!preservesLines)
+            continue;
+
+        size_t base = symmetries.table.size();
+        symmetries.table.resize(base + 4 * 256, 0);
+        for (int chunk = 0; chunk < 4; chunk++)
+        {
+            for (int byte = 0; byte < 256; byte++)
+            {
+                uint32_t image = 0;
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    int cell = chunk * 8 + bit;
+                    if (((byte >> bit) & 1) && cell < graph.cellCount)
+                        image |= 1u << permutation[cell];
+                }
+                symmetries.table[base + chunk * 256 + byte] = image;
+            }
+        }
+        symmetries.count++;
+    }
+    return symmetries;
+}
+
+struct CensusWalker
+{
+    const HypergraphRules* rules = nullptr;
+    const BoardSymmetries* symmetries;
+    ConcurrentKeySet* seen;
+    bool packed;                 // keys are packed 32-bit states
+    HypergraphState state;
+    uint32_t masks[2];
+    std::vector<int> moves;
+    std::vector<CensusPly> plies;
+
+    // Moves leading to nodes at `splitPly`, which are left for the workers
+    int splitPly;
+    std::vector<std::vector<int>>* frontier;
+    std::vector<int> path;
+};
+
+static void playMove(CensusWalker& walker, int move)
+{
+    walker.masks[walker.state.toMove] |= 1u << move;
+    walker.rules->makeMove(walker.state, move);
+    walker.path.push_back(move);
+}
+
+static void takeBack(CensusWalker& walker, int move)
+{
+    walker.rules->unmakeMove(walker.state, move);
+    walker.masks[walker.state.toMove] &= ~(1u << move);
+    walker.path.pop_back();
+}
+
+static void expand(CensusWalker& walker);
+
+static void visit(CensusWalker& walker)
+{
+    if (walker.seen->full())
+        return;
+    uint64_t key = walker.packed
+        ? packCanonicalState(*walker.symmetries, walker.masks[0], walker.masks[1], walker.state.toMove)
+        : canonicalKey(*walker.symmetries, walker.masks[0], walker.masks[1]);
+    if (!walker.seen->insert(key))
+        return;
+
+    int ply = walker.state.moveCount;
+    CensusPly& counts = walker.plies[ply];
+    counts.positions++;
+
+    if (walker.rules->isTerminal(walker.state))
+    {
+        counts.terminal++;
+        if (walker.state.status == GAME_X_WINS)
+            counts.xWins++;
+        else if (walker.state.status == GAME_O_WINS)
+            counts.oWins++;
+        else
+            counts.draws++;
+        return;
+    }
+
+    if (ply == walker.splitPly)
+    {
+        walker.frontier->push_back(walker.path);
+        return;
+    }
+    expand(walker);
+}
+
+static void expand(CensusWalker& walker)
+{
+    int cellCount = walker.rules->graph.cellCount;
+    int* moves = &walker.moves[(size_t)walker.state.moveCount * cellCount];
+    int count = walker.rules->generateMoves(walker.state, moves);
+
+    for (int i = 0; i < count; i++)
+    {
+        playMove(walker, moves[i]);
+        visit(walker);
+        takeBack(walker, moves[i]);
+    }
+}
+
+static void initWalker(CensusWalker& walker, const HypergraphRules& rules, const BoardSymmetries& symmetries, ConcurrentKeySet& seen)
+{
+    int cellCount = rules.graph.cellCount;
+    walker.rules = &rules;
+    walker.symmetries = &symmetries;
+    walker.seen = &seen;
+    walker.packed = cellCount <= PACKED_STATE_MAX_CELLS;
+    rules.reset(walker.state);
+    walker.masks[0] = walker.masks[1] = 0;
+    walker.moves.resize((size_t)(cellCount + 1) * cellCount);
+    walker.plies.assign(cellCount + 1, CensusPly());
+    walker.splitPly = -1;
+    walker.frontier = nullptr;
+    walker.path.clear();
+}
+
+CensusResult runCensus(const HypergraphRules& rules, bool useSymmetry, TaskPool& pool, int tableSizeLog2)
+{
+    CensusResult result;
+    int cellCount = rules.graph.cellCount;
+    if (cellCount > 32)
+        return result;
+
+    BoardSymmetries symmetries = findSymmetries(rules.graph, useSymmetry);
+    ConcurrentKeySet seen(tableSizeLog2, &pool, cellCount <= PACKED_STATE_MAX_CELLS);
+    result.symmetries = symmetries.count;
+    result.tableBytes = seen.bytes();
+
+    // Walk the first plies on this thread to build a frontier of distinct
+    // positions, then let the workers expand those
+    std::vector<std::vector<int>> frontier;
+    CensusWalker root;
+    initWalker(root, rules, symmetries, seen);
+    root.splitPly = std::min(cellCount <= 9 ? 2 : 3, cellCount);
+    root.frontier = &frontier;
+    visit(root);
+
+    // One walker per pool worker, set up by that worker so its buffers are
+    // node-local; a frontier position is one task
+    std::vector<CensusWalker> walkers(pool.size());
+    parallelFor(pool, 0, frontier.size(), 1, [&](uint64_t i)
+    {
+        CensusWalker& walker = walkers[pool.currentWorker()];
+        if (walker.rules == nullptr)
+            initWalker(walker, rules, symmetries, seen);
+        for (size_t m = 0; m < frontier[i].size(); m++)
+            playMove(walker, frontier[i][m]);
+        expand(walker);
+        for (size_t m = frontier[i].size(); m-- > 0;)
+            takeBack(walker, frontier[i][m]);
+    });
+
+    result.plies = root.plies;
+    for (int t = 0; t < pool.size(); t++)
+    {
+        // Workers that never got a task have nothing to add
+        if (walkers[t].rules == nullptr)
+            continue;
+        for (int ply = 0; ply <= cellCount; ply++)
+        {
+            result.plies[ply].positions += walkers[t].plies[ply].positions;
+            result.plies[ply].terminal += walkers[t].plies[ply].terminal;
+            result.plies[ply].xWins += walkers[t].plies[ply].xWins;
+            result.plies[ply].oWins += walkers[t].plies[ply].oWins;
+            result.plies[ply].draws += walkers[t].plies[ply].draws;
+        }
+    }
+
+    result.total = seen.size();
+    result.overflow = seen.full();
+    return result;
+}
+
+int runCensusCommand(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, 2, options))
+        return 1;
+
+    Hypergraph graph;
+    if (!makeGameFromOptions(options, graph))
+        return 1;
+    HypergraphRules rules(graph, hasOption(options, "early-draws"));
+    int cellCount = rules.graph.cellCount;
+    if (cellCount > 32)
+    {
+        std::cout << "census supports boards of at most 32 cells" << std::endl;
+        return 1;
+    }
+
+    TaskPool& pool = taskPoolFromOptions(options);
+
+    // Size the table from 3^cells, which bounds the number of positions
+    int sizeLog2 = 10;
+    double bound = pow(3.0, cellCount) / (hasOption(options, "no-symmetry") ? 1 : 4);
+    while (sizeLog2 < 28 && (double)((uint64_t)1 << sizeLog2) < bound * 1.5)
+        sizeLog2++;
+    long long tableLog2 = getIntOption(options, "table-log2", sizeLog2);
+    if (tableLog2 < 10 || tableLog2 > 34)
+    {
+        std::cout << "Expected --table-log2 from 10 to 34" << std::endl;
+        return 1;
+    }
+    sizeLog2 = (int)tableLog2;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CensusResult result = runCensus(rules, !hasOption(options, "no-symmetry"), pool, sizeLog2);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (result.overflow)
+    {
+        std::cout << "Position table is full, rerun with a larger --table-log2" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::setw(4) << "ply" << std::setw(14) << "positions" << std::setw(12) << "terminal"
+        << std::setw(12) << "x-wins" << std::setw(12) << "o-wins" << std::setw(12) << "draws"
+        << std::setw(11) << "branching" << std::endl;
+
+    // Branching factor: distinct children per distinct non-terminal parent
+    double logSum = 0;
+    int branchingPlies = 0;
+    for (int ply = 0; ply <= cellCount; ply++)
+    {
+        const CensusPly& counts = result.plies[ply];
+        if (counts.positions == 0)
+            break;
+
+        std::cout << std::setw(4) << ply << std::setw(14) << counts.positions << std::setw(12) << counts.terminal
+            << std::setw(12) << counts.xWins << std::setw(12) << counts.oWins << std::setw(12) << counts.draws;
+
+        uint64_t parents = counts.positions - counts.terminal;
+        if (ply < cellCount && parents > 0 && result.plies[ply + 1].positions > 0)
+        {
+            double branching = (double)result.plies[ply + 1].positions / parents;
+            logSum += log(branching);
+            branchingPlies++;
+            std::cout << std::setw(11) << std::fixed << std::setprecision(2) << branching;
+        }
+        std::cout << std::endl;
+    }
+
+    uint64_t terminal = 0;
+    for (int ply = 0; ply <= cellCount; ply++)
+        terminal += result.plies[ply].terminal;
+
+    std::cout << "total: " << result.total << " positions, " << terminal << " terminal, "
+        << result.symmetries << " symmetries, table " << result.tableBytes / 1024 << " KiB" << std::endl;
+    if (branchingPlies > 0)
+        std::cout << "effective branching factor: " << std::fixed << std::setprecision(3) << exp(logSum / branchingPlies) << std::endl;
+    std::cout << "time: " << (long long)(seconds * 1000) << " ms, threads: " << pool.describe() << std::endl;
+    return 0;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "rules.h"
+#include "task_pool.h"
+
+// Lock-free open-addressing set of 64-bit keys with linear probing. Slots
+// hold key + 1 so that zero can mark an empty slot. With narrow keys (all
+// below 2^32 - 1, such as packed states) the slots are 32 bits wide, which
+// halves the table.
+class ConcurrentKeySet
+{
+public:
+    // With a pool, the table is cleared by its workers: pinned workers spread
+    // its pages over their NUMA nodes instead of piling them on one
+    explicit ConcurrentKeySet(int sizeLog2, TaskPool* pool = nullptr, bool narrowKeys = false);
+
+    // Returns true if the key was not in the set yet. Safe to call from any
+    // number of threads at once.
+    bool insert(uint64_t key);
+
+    uint64_t size() const
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    bool full() const
+    {
+        return size() > capacity() - capacity() / 8;
+    }
+
+    uint64_t bytes() const
+    {
+        return capacity() * (narrowSlots ? sizeof(uint32_t) : sizeof(uint64_t));
+    }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    std::unique_ptr<std::atomic<uint32_t>[]> narrowSlots;
+    uint64_t mask;
+    std::atomic<uint64_t> count;
+};
+
+// Board symmetries as cell permutations. Only the rotations and reflections
+// that map the game's set of lines onto itself are kept, so the same code
+// works for grids, tori and hex boards.
+struct BoardSymmetries
+{
+    int count = 0;
+    // table[s][chunk][byte]: mask bits of an 8-cell chunk moved by symmetry s
+    std::vector<uint32_t> table;
+};
+
+BoardSymmetries findSymmetries(const Hypergraph& graph, bool enabled);
+
+// Smallest key over all symmetric images of the position
+inline uint64_t canonicalKey(const BoardSymmetries& symmetries, uint32_t xMask, uint32_t oMask)
+{
+    uint64_t best = ~0ULL;
+    const uint32_t* table = &symmetries.table[0];
+
+    for (int s = 0; s < symmetries.count; s++, table += 4 * 256)
+    {
+        uint32_t x = table[xMask & 255] | table[256 + ((xMask >> 8) & 255)]
+            | table[512 + ((xMask >> 16) & 255)] | table[768 + (xMask >> 24)];
+        uint32_t o = table[oMask & 255] | table[256 + ((oMask >> 8) & 255)]
+            | table[512 + ((oMask >> 16) & 255)] | table[768 + (oMask >> 24)];
+        uint64_t key = x | ((uint64_t)o << 32);
+        if (key < best)
+            best = key;
+    }
+    return best;
+}
+
+struct CensusPly
+{
+    uint64_t positions = 0;
+    uint64_t terminal = 0;
+    uint64_t xWins = 0;
+    uint64_t oWins = 0;
+    uint64_t draws = 0;
+};
+
+struct CensusResult
+{
+    std::vector<CensusPly> plies;
+    uint64_t total = 0;
+    int symmetries = 0;
+    uint64_t tableBytes = 0;
+    bool overflow = false;
+};
+
+// Walks the whole game tree in parallel and counts every distinct position
+// (up to symmetry) once. Boards are limited to 32 cells; boards of up to 16
+// cells are keyed by packed 32-bit states (see packed_state.h).
+CensusResult runCensus(const HypergraphRules& rules, bool useSymmetry, TaskPool& pool, int tableSizeLog2);
+
+// `tictactoe-cli census ...`
+int runCensusCommand(int argc, char** argv);
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <string>
+#include "bitplane.h"
+#include "census.h"
+#include "distributed.h"
+#include "perft.h"
+#include "playout.h"
+#include "selfplay.h"
+#include "tournament.h"
+#include "trainer.h"
+#include "vector_env.h"
+
+// Headless tools that share the engine code with the game window
+static void printUsage()
+{
+    std::cout << "Usage: tictactoe-cli <command> [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Commands:" << std::endl;
+    std::cout << "  perft   Count game-tree leaves to a given depth" << std::endl;
+    std::cout << "          --depth D --threads N --moves c1,c2,... --divide --early-draws" << std::endl;
+    std::cout << "  census  Count distinct positions per ply over the whole game tree" << std::endl;
+    std::cout << "          --threads N --no-symmetry --early-draws --table-log2 B" << std::endl;
+    std::cout << "  playout Play random games to completion and report the results" << std::endl;
+    std::cout << "          --games N --seed S --moves c1,c2,..." << std::endl;
+    std::cout << "  scan    Check and time bit-plane win/threat scans on random grids up to 64x64" << std::endl;
+    std::cout << "          --rows R --cols C --k K --positions N --fill PERCENT --seed S" << std::endl;
+    std::cout << "  tournament  Play engine configurations against each other and estimate Elo" << std::endl;
+    std::cout << "          --engines \"name:depth=D,nodes=N,movetime=MS;name2:random;...\"" << std::endl;
+    std::cout << "          --mode roundrobin|gauntlet --openings N --opening-plies P --rounds R" << std::endl;
+    std::cout << "          --balance-depth D --balance-margin M --threads N --seed S" << std::endl;
+    std::cout << "          --sprt elo0,elo1 --alpha A --beta B" << std::endl;
+    std::cout << "  selfplay    Generate training positions from engine self-play into binary shards" << std::endl;
+    std::cout << "          --engine \"name:depth=D,...\" --games N --threads N --shards S --out PREFIX" << std::endl;
+    std::cout << "          --opening-plies P --seed S" << std::endl;
+    std::cout << "  coordinator Hand out selfplay or tournament games to workers over TCP" << std::endl;
+    std::cout << "          --job selfplay|tournament --port P --batch N --batch-timeout SECONDS" << std::endl;
+    std::cout << "          plus the selfplay or tournament options (--threads is up to each worker)" << std::endl;
+    std::cout << "  worker  Play games for a coordinator" << std::endl;
+    std::cout << "          --connect HOST:PORT --threads N --retry SECONDS" << std::endl;
+    std::cout << "  train   Learn pattern evaluation weights by TD self-play on all threads" << std::endl;
+    std::cout << "          --games N --alpha A --epsilon E --threads N --seed S --init FILE" << std::endl;
+    std::cout << "          --out FILE --snapshot-every N --report N --curve CSV" << std::endl;
+    std::cout << "  vecenv  Step many games at once through the vector environment and time it" << std::endl;
+    std::cout << "          --envs N --steps S --agent x|o|self --threads N --seed S" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Board options (all commands):" << std::endl;
+    std::cout << "  --game grid|torus|hex --rows R --cols C --k K   (default 3x3, k = 3)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Thread options (commands with --threads):" << std::endl;
+    std::cout << "  --pin none|compact|spread   pin workers to CPUs, filling one NUMA node first or" << std::endl;
+    std::cout << "                              alternating between nodes (default none)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::string command = argv[1];
+    if (command == "perft")
+        return runPerftCommand(argc, argv);
+    if (command == "census")
+        return runCensusCommand(argc, argv);
+    if (command == "playout")
+        return runPlayoutCommand(argc, argv);
+    if (command == "scan")
+        return runScanCommand(argc, argv);
+    if (command == "tournament")
+        return runTournamentCommand(argc, argv);
+    if (command == "selfplay")
+        return runSelfPlayCommand(argc, argv);
+    if (command == "coordinator")
+        return runCoordinatorCommand(argc, argv);
+    if (command == "worker")
+        return runWorkerCommand(argc, argv);
+    if (command == "train")
+        return runTrainCommand(argc, argv);
+    if (command == "vecenv")
+        return runVectorEnvCommand(argc, argv);
+
+    printUsage();
+    return 1;
+}
@@ -0,0 +1,58 @@
+#include "cpu_features.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static const char* const LEVEL_NAMES[SIMD_LEVEL_COUNT] = {"scalar", "sse4.2", "avx2", "avx512"};
+
+SimdLevel detectSimdLevel()
+{
+#if defined(TICTACTOE_X86_KERNELS)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+        return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+        return SIMD_SSE42;
+#endif
+    return SIMD_SCALAR;
+}
+
+static SimdLevel chooseSimdLevel()
+{
+    SimdLevel detected = detectSimdLevel();
+    const char* forced = getenv("TICTACTOE_SIMD");
+    if (forced == nullptr || *forced == '\0')
+        return detected;
+
+    for (int level = 0; level < SIMD_LEVEL_COUNT; level++)
+    {
+        if (strcmp(forced, LEVEL_NAMES[level]) != 0)
+            continue;
+        if (level > detected)
+        {
+            std::cerr << "TICTACTOE_SIMD=" << forced << " is not supported here, using "
+                << LEVEL_NAMES[detected] << std::endl;
+            return detected;
+        }
+        return (SimdLevel)level;
+    }
+
+    std::cerr << "Unknown TICTACTOE_SIMD=" << forced << " (expected scalar, sse4.2, avx2 or avx512), using "
+        << LEVEL_NAMES[detected] << std::endl;
+    return detected;
+}
+
+SimdLevel activeSimdLevel()
+{
+    // Thread-safe one-time initialisation
+    static const SimdLevel level = chooseSimdLevel();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+    return level >= 0 && level < SIMD_LEVEL_COUNT ? LEVEL_NAMES[level] : "unknown";
+}
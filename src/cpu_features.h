@@ -0,0 +1,23 @@
+#pragma once
+
+// Instruction sets the SIMD kernels are built for, in increasing order. Every
+// kernel is compiled once per level and the level is chosen at startup from
+// cpuid, so one binary runs on the whole fleet.
+enum SimdLevel
+{
+    SIMD_SCALAR = 0,
+    SIMD_SSE42,
+    SIMD_AVX2,
+    SIMD_AVX512,
+    SIMD_LEVEL_COUNT
+};
+
+// Best level this CPU supports (and this build contains)
+SimdLevel detectSimdLevel();
+
+// The level the kernels use: detectSimdLevel(), unless the environment
+// variable TICTACTOE_SIMD (scalar, sse4.2, avx2 or avx512) asks for a lower
+// one, e.g. to benchmark the fallbacks. Decided on first use.
+SimdLevel activeSimdLevel();
+
+const char* simdLevelName(SimdLevel level);
@@ -0,0 +1,444 @@
+#include "distributed.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "net.h"
+#include "selfplay.h"
+#include "tournament.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// Options that only concern the coordinator; everything else goes to the
+// workers so they set up exactly the same job
+static bool isCoordinatorOption(const std::string& name)
+{
+    return name == "bind" || name == "port" || name == "batch" || name == "batch-timeout" || name == "threads" || name == "out"
+        || name == "shards";
+}
+
+static std::vector<uint8_t> encodeJob(const Options& options)
+{
+    std::vector<uint8_t> payload;
+    for (std::map<std::string, std::string>::const_iterator it = options.values.begin(); it != options.values.end(); ++it)
+    {
+        if (isCoordinatorOption(it->first))
+            continue;
+        payload.insert(payload.end(), it->first.begin(), it->first.end());
+        payload.push_back(0);
+        payload.insert(payload.end(), it->second.begin(), it->second.end());
+        payload.push_back(0);
+    }
+    return payload;
+}
+
+static bool decodeJob(const std::vector<uint8_t>& payload, Options& options)
+{
+    std::vector<std::string> fields;
+    std::string field;
+    for (size_t i = 0; i < payload.size(); i++)
+    {
+        if (payload[i] == 0)
+        {
+            fields.push_back(field);
+            field.clear();
+        }
+        else
+            field.push_back((char)payload[i]);
+    }
+    if (!field.empty() || fields.size() % 2 != 0)
+        return false;
+    for (size_t i = 0; i < fields.size(); i += 2)
+        options.values[fields[i]] = fields[i + 1];
+    return true;
+}
+
+// The job both sides set up from the same options
+struct DistributedJob
+{
+    std::string kind;            // "selfplay" or "tournament"
+    std::unique_ptr<HypergraphRules> rules;
+    SelfPlaySetup selfPlay;
+    TournamentSetup tournament;
+
+    uint64_t totalGames() const
+    {
+        return kind == "selfplay" ? selfPlay.games : tournament.totalGames;
+    }
+};
+
+static bool setupJob(const Options& options, DistributedJob& job)
+{
+    job.kind = getOption(options, "job", "selfplay");
+    Hypergraph graph;
+    if (!makeGameFromOptions(options, graph))
+        return false;
+    job.rules.reset(new HypergraphRules(graph));
+    if (job.kind == "selfplay")
+        return setupSelfPlay(options, *job.rules, job.selfPlay);
+    if (job.kind == "tournament")
+        return setupTournament(options, *job.rules, job.tournament);
+
+    std::cout << "Unknown --job " << job.kind << " (expected selfplay or tournament)" << std::endl;
+    return false;
+}
+
+struct Batch
+{
+    uint64_t first;
+    uint32_t count;
+};
+
+struct WorkerConnection
+{
+    NetSocket socket = NET_INVALID_SOCKET;
+    std::string peer;
+    bool ready = false;          // HELLO received and JOB sent
+    std::vector<uint8_t> inbox;
+    std::deque<Batch> inFlight;
+    Clock::time_point waitingSince;
+};
+
+int runCoordinatorCommand(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, 2, options))
+        return 1;
+
+    DistributedJob job;
+    if (!setupJob(options, job))
+        return 1;
+
+    // Loopback unless the network is asked for: anyone who reaches the port
+    // can take batches and send back results
+    std::string bindAddress = getOption(options, "bind", "127.0.0.1");
+    int port = (int)getIntOption(options, "port", 7878);
+    uint32_t batchSize = (uint32_t)getIntOption(options, "batch", 32);
+    if (batchSize < 1)
+        batchSize = 1;
+    double batchTimeout = getDoubleOption(options, "batch-timeout", 300.0);
+
+    SelfPlayWriter writer;
+    SelfPlayTotals selfPlayTotals;
+    TournamentResults tournamentResults;
+    int recordSize = selfPlayRecordSize(job.rules->graph.cellCount);
+    if (job.kind == "selfplay")
+    {
+        int shardCount = (int)getIntOption(options, "shards", 1);
+        std::string prefix = getOption(options, "out", "selfplay");
+        if (!writer.open(prefix, shardCount < 1 ? 1 : shardCount, *job.rules, job.selfPlay))
+            return 1;
+        std::cout << "engine: " << describeEngineConfig(job.selfPlay.engine) << ", games: " << job.selfPlay.games
+            << ", output: " << prefix << "-NNN.bin x " << writer.shardCount() << std::endl;
+    }
+    else
+        printTournamentSetup(job.tournament);
+
+    if (!netStartup())
+        return 1;
+    NetSocket listener = netListen(bindAddress, port);
+    if (listener == NET_INVALID_SOCKET)
+        return 1;
+    std::cout << "batches of " << batchSize << " games, waiting for workers on " << bindAddress << ":" << port
+        << std::endl;
+
+    std::deque<Batch> pending;
+    for (uint64_t first = 0; first < job.totalGames(); first += batchSize)
+    {
+        Batch batch = {first, (uint32_t)std::min<uint64_t>(batchSize, job.totalGames() - first)};
+        pending.push_back(batch);
+    }
+
+    std::vector<uint8_t> jobPayload = encodeJob(options);
+    std::vector<std::unique_ptr<WorkerConnection> > workers;
+    uint64_t gamesDone = 0;
+    bool stop = false;
+    Clock::time_point start = Clock::now(), lastProgress = start;
+
+    // Puts the worker's batches back at the front of the queue
+    auto dropWorker = [&](size_t w, const char* reason)
+    {
+        WorkerConnection& worker = *workers[w];
+        std::cout << "worker " << worker.peer << " lost (" << reason << "), requeueing " << worker.inFlight.size()
+            << " batches" << std::endl;
+        for (size_t b = worker.inFlight.size(); b-- > 0;)
+            pending.push_front(worker.inFlight[b]);
+        netClose(worker.socket);
+        workers.erase(workers.begin() + w);
+    };
+
+    // Returns false on a malformed message
+    auto handleMessage = [&](WorkerConnection& worker, const NetMessage& message) -> bool
+    {
+        if (message.type == MSG_HELLO)
+        {
+            if (message.payload.size() < 8 || netGetU32(&message.payload[0]) != DISTRIBUTED_PROTOCOL_VERSION)
+                return false;
+            std::cout << "worker " << worker.peer << " joined with " << netGetU32(&message.payload[4]) << " threads"
+                << std::endl;
+            worker.ready = true;
+            return netSendMessage(worker.socket, MSG_JOB, jobPayload);
+        }
+        if (message.type != MSG_RESULT || message.payload.size() < 12 || worker.inFlight.empty())
+            return false;
+
+        const Batch& batch = worker.inFlight.front();
+        const uint8_t* data = &message.payload[0];
+        if (netGetU64(data) != batch.first || netGetU32(data + 8) != batch.count
+            || message.payload.size() < 12 + (size_t)batch.count)
+            return false;
+        const uint8_t* statuses = data + 12;
+        size_t recordBytes = message.payload.size() - 12 - batch.count;
+
+        if (job.kind == "selfplay")
+        {
+            if (recordBytes % recordSize != 0)
+                return false;
+            writer.write((int)(batch.first / batchSize), statuses + batch.count, recordBytes);
+            selfPlayTotals.positions += recordBytes / recordSize;
+            for (uint32_t i = 0; i < batch.count; i++)
+                selfPlayTotals.outcomes[statuses[i] == GAME_X_WINS ? 1 : statuses[i] == GAME_O_WINS ? 2 : 0]++;
+            selfPlayTotals.games += batch.count;
+        }
+        else
+        {
+            for (uint32_t i = 0; i < batch.count && !stop; i++)
+            {
+                if (recordTournamentGame(job.tournament, tournamentResults, batch.first + i, statuses[i]))
+                    stop = true;
+            }
+        }
+
+        gamesDone += batch.count;
+        worker.inFlight.pop_front();
+        worker.waitingSince = Clock::now();
+        return true;
+    };
+
+    while (gamesDone < job.totalGames() && !stop)
+    {
+        std::vector<NetSocket> sockets(1, listener);
+        for (size_t w = 0; w < workers.size(); w++)
+            sockets.push_back(workers[w]->socket);
+        std::vector<bool> ready;
+        if (!netWaitReadable(sockets, 500, ready))
+        {
+            std::cout << "select failed" << std::endl;
+            break;
+        }
+
+        if (ready[0])
+        {
+            std::unique_ptr<WorkerConnection> worker(new WorkerConnection());
+            worker->socket = netAccept(listener, worker->peer);
+            if (worker->socket != NET_INVALID_SOCKET)
+                workers.push_back(std::move(worker));
+        }
+
+        // Walk backwards so dropping a worker keeps the indices valid
+        for (size_t w = ready.size() - 1; w >= 1; w--)
+        {
+            if (!ready[w])
+                continue;
+            WorkerConnection& worker = *workers[w - 1];
+            uint8_t chunk[65536];
+            int received = netRecvSome(worker.socket, chunk, sizeof(chunk));
+            if (received <= 0)
+            {
+                dropWorker(w - 1, "disconnected");
+                continue;
+            }
+            worker.inbox.insert(worker.inbox.end(), chunk, chunk + received);
+
+            NetMessage message;
+            int taken;
+            bool valid = true;
+            while (valid && (taken = netTakeMessage(worker.inbox, message)) != 0)
+                valid = taken > 0 && handleMessage(worker, message);
+            if (!valid)
+                dropWorker(w - 1, "bad message");
+        }
+
+        Clock::time_point now = Clock::now();
+        for (size_t w = workers.size(); w-- > 0;)
+        {
+            WorkerConnection& worker = *workers[w];
+            if (!worker.inFlight.empty() && std::chrono::duration<double>(now - worker.waitingSince).count() > batchTimeout)
+                dropWorker(w, "batch timed out");
+        }
+
+        // Keep two batches queued on every worker
+        for (size_t w = workers.size(); w-- > 0 && !stop;)
+        {
+            WorkerConnection& worker = *workers[w];
+            bool sent = true;
+            while (sent && worker.ready && worker.inFlight.size() < 2 && !pending.empty())
+            {
+                std::vector<uint8_t> payload;
+                netPutU64(payload, pending.front().first);
+                netPutU32(payload, pending.front().count);
+                sent = netSendMessage(worker.socket, MSG_BATCH, payload);
+                if (sent)
+                {
+                    if (worker.inFlight.empty())
+                        worker.waitingSince = now;
+                    worker.inFlight.push_back(pending.front());
+                    pending.pop_front();
+                }
+            }
+            if (!sent)
+                dropWorker(w, "send failed");
+        }
+
+        if (std::chrono::duration<double>(now - lastProgress).count() >= 10.0)
+        {
+            std::cout << "games: " << gamesDone << " / " << job.totalGames() << ", workers: " << workers.size() << std::endl;
+            lastProgress = now;
+        }
+    }
+
+    for (size_t w = 0; w < workers.size(); w++)
+    {
+        netSendMessage(workers[w]->socket, MSG_DONE, std::vector<uint8_t>());
+        netClose(workers[w]->socket);
+    }
+    netClose(listener);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (job.kind == "selfplay")
+    {
+        int shardCount = writer.shardCount();
+        if (!writer.close())
+        {
+            std::cout << "Writing the shards failed (disk full?)" << std::endl;
+            return 1;
+        }
+        printSelfPlaySummary(selfPlayTotals, job.rules->graph.cellCount, shardCount, seconds);
+    }
+    else
+        printTournamentReport(job.tournament, tournamentResults, seconds);
+    return 0;
+}
+
+// Per-worker generators and players, kept for the whole connection
+struct WorkerSlot
+{
+    std::unique_ptr<SelfPlayGenerator> generator;
+    std::vector<std::unique_ptr<MatchPlayer> > players;
+    std::vector<uint8_t> records;
+    uint64_t positions = 0;
+};
+
+// Plays one batch on the pool, one task per game, into a RESULT payload
+static void playBatch(const DistributedJob& job, TaskPool& pool, std::vector<WorkerSlot>& slots, uint64_t first,
+    uint32_t count, std::vector<uint8_t>& payload)
+{
+    std::vector<uint8_t> statuses(count);
+    for (size_t t = 0; t < slots.size(); t++)
+        slots[t].records.clear();
+
+    parallelFor(pool, 0, count, 1, [&](uint64_t i)
+    {
+        WorkerSlot& slot = slots[pool.currentWorker()];
+        if (job.kind == "selfplay")
+        {
+            if (!slot.generator)
+                slot.generator.reset(new SelfPlayGenerator(*job.rules, job.selfPlay));
+            statuses[i] = (uint8_t)slot.generator->playGame(first + i, slot.records, slot.positions);
+        }
+        else
+        {
+            if (slot.players.empty())
+                slot.players = makeTournamentPlayers(*job.rules, job.tournament);
+            statuses[i] = (uint8_t)playTournamentGame(*job.rules, job.tournament, slot.players, first + i);
+        }
+    });
+
+    payload.clear();
+    netPutU64(payload, first);
+    netPutU32(payload, count);
+    payload.insert(payload.end(), statuses.begin(), statuses.end());
+    for (size_t t = 0; t < slots.size(); t++)
+        payload.insert(payload.end(), slots[t].records.begin(), slots[t].records.end());
+}
+
+int runWorkerCommand(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, 2, options))
+        return 1;
+
+    std::string address = getOption(options, "connect", "127.0.0.1:7878");
+    TaskPool& pool = taskPoolFromOptions(options);
+    double retrySeconds = getDoubleOption(options, "retry", 30.0);
+
+    if (!netStartup())
+        return 1;
+
+    // The coordinator may not be up yet
+    NetSocket socket = NET_INVALID_SOCKET;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds((int64_t)(retrySeconds * 1000));
+    while ((socket = netConnect(address)) == NET_INVALID_SOCKET && Clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    if (socket == NET_INVALID_SOCKET)
+    {
+        std::cout << "Cannot connect to " << address << std::endl;
+        return 1;
+    }
+
+    std::vector<uint8_t> hello;
+    netPutU32(hello, DISTRIBUTED_PROTOCOL_VERSION);
+    netPutU32(hello, (uint32_t)pool.size());
+    NetMessage message;
+    if (!netSendMessage(socket, MSG_HELLO, hello) || !netRecvMessage(socket, message) || message.type != MSG_JOB)
+    {
+        std::cout << "No job from " << address << std::endl;
+        netClose(socket);
+        return 1;
+    }
+
+    Options jobOptions;
+    DistributedJob job;
+    if (!decodeJob(message.payload, jobOptions) || !setupJob(jobOptions, job))
+    {
+        netClose(socket);
+        return 1;
+    }
+    std::cout << "connected to " << address << ", job: " << job.kind << ", threads: " << pool.describe() << std::endl;
+
+    std::vector<WorkerSlot> slots(pool.size());
+    uint64_t games = 0;
+    Clock::time_point start = Clock::now();
+    std::vector<uint8_t> payload;
+    bool done = false;
+    while (netRecvMessage(socket, message))
+    {
+        if (message.type == MSG_DONE)
+        {
+            done = true;
+            break;
+        }
+        if (message.type != MSG_BATCH || message.payload.size() < 12)
+            break;
+
+        uint64_t first = netGetU64(&message.payload[0]);
+        uint32_t count = netGetU32(&message.payload[8]);
+        if (first + count > job.totalGames())
+            break;
+        playBatch(job, pool, slots, first, count, payload);
+        if (!netSendMessage(socket, MSG_RESULT, payload))
+            break;
+        games += count;
+    }
+    netClose(socket);
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << (done ? "done" : "connection lost") << ", games: " << games << ", games/s: "
+        << (long long)(seconds > 0 ? games / seconds : 0) << std::endl;
+    return done ? 0 : 1;
+}
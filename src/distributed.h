@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+// Self-play and tournaments spread over several machines. A coordinator
+// listens on a TCP port and hands out batches of game numbers; workers
+// connect, play the batches on all their threads and send back one binary
+// result message per batch. Game g is played the same way on any worker (see
+// SelfPlaySetup and TournamentSetup), so the output does not depend on how
+// the batches were spread.
+//
+// Every message is a uint32 payload size, a uint8 type and the payload, all
+// little-endian:
+//
+//   HELLO   worker -> coordinator   uint32 protocol version, uint32 threads
+//   JOB     coordinator -> worker   the job's options as "name\0value\0" pairs
+//   BATCH   coordinator -> worker   uint64 first game, uint32 game count
+//   RESULT  worker -> coordinator   uint64 first game, uint32 game count,
+//                                   one GameStatus byte per game, then for
+//                                   self-play the games' records
+//   DONE    coordinator -> worker   no payload; the worker exits
+//
+// Each worker gets up to two batches at a time so it never waits for the
+// next one. A batch goes back to the queue if its worker disconnects or
+// takes longer than --batch-timeout.
+
+const uint32_t DISTRIBUTED_PROTOCOL_VERSION = 1;
+
+enum DistributedMessage
+{
+    MSG_HELLO = 1,
+    MSG_JOB = 2,
+    MSG_BATCH = 3,
+    MSG_RESULT = 4,
+    MSG_DONE = 5
+};
+
+// `tictactoe-cli coordinator --job selfplay|tournament ...`
+int runCoordinatorCommand(int argc, char** argv);
+
+// `tictactoe-cli worker --connect host:port ...`
+int runWorkerCommand(int argc, char** argv);
@@ -0,0 +1,472 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "infinite_board.h"
+#include "options.h"
+#include "search.h"
+
+// Text protocol for driving the engine from another program, in the spirit
+// of UCI / Gomocup. One command per line on stdin, replies on stdout:
+//
+//   rules grid|torus|hex R C K    pick the board (resets the game)
+//   rules infinite K              K-in-a-row on the unbounded board
+//   weights FILE|none             evaluate with trained pattern weights, or
+//                                 back to the built-in evaluation
+//   newgame                       back to the empty board, forget the table
+//   position startpos [moves c1 c2 ...]
+//   go [depth D] [nodes N] [movetime MS] [infinite] [multipv N]
+//                                 "infinite" waits for "stop" to answer
+//   stop                          finish the running search now
+//   isready                       answered with "readyok"
+//   board                         print the current position
+//   quit
+//
+// Moves are cell indices (row * cols + col), or "x,y" on the infinite board,
+// where the first move is 0,0 and every later one lands within
+// INFINITE_MOVE_RADIUS cells of a stone. While a search runs the engine
+// prints "info depth .. score .. nodes .. nps .. time .. pv .." after every
+// iteration and ends with "bestmove <move>" ("bestmove none" if the game is
+// over). With multipv N each iteration prints the N best moves, ranked by an
+// extra "multipv K" field. Scores are "cp N" from the side to move, or "win N" / "loss N" for a
+// forced result N plies away.
+
+class Engine
+{
+public:
+    Engine() : stopSearch(false)
+    {
+        setRules(makeGridGame(3, 3, 3));
+    }
+
+    ~Engine()
+    {
+        stop();
+    }
+
+    // Returns false on "quit"
+    bool handle(const std::string& line)
+    {
+        std::istringstream in(line);
+        std::string command;
+        if (!(in >> command))
+            return true;
+
+        if (command == "quit")
+            return false;
+        if (command == "isready")
+            send("readyok");
+        else if (command == "stop")
+            stop();
+        else if (command == "rules")
+            handleRules(in);
+        else if (command == "weights")
+            handleWeights(in);
+        else if (command == "newgame")
+        {
+            stop();
+            if (infiniteRules)
+            {
+                infiniteSearch->clear();
+                infiniteRules->reset(infiniteState);
+            }
+            else
+            {
+                search->clear();
+                rules->reset(state);
+            }
+        }
+        else if (command == "position")
+        {
+            if (infiniteRules)
+                handlePosition(*infiniteRules, infiniteState, in);
+            else
+                handlePosition(*rules, state, in);
+        }
+        else if (command == "go")
+            handleGo(in);
+        else if (command == "board")
+            printBoard();
+        else
+            send("info string unknown command: " + command);
+        return true;
+    }
+
+private:
+    void setRules(const Hypergraph& graph)
+    {
+        // The search keeps a reference to the rules, so it goes first
+        infiniteSearch.reset();
+        infiniteRules.reset();
+        search.reset();
+        rules.reset(new HypergraphRules(graph));
+        rules->patterns = weights;
+        search.reset(new AlphaBetaSearch<HypergraphRules>(*rules));
+        rules->reset(state);
+    }
+
+    // The board game stays loaded underneath, for "weights"
+    void setInfiniteRules(int k)
+    {
+        infiniteSearch.reset();
+        infiniteRules.reset(new InfiniteRules(k));
+        infiniteSearch.reset(new AlphaBetaSearch<InfiniteRules>(*infiniteRules));
+        infiniteRules->reset(infiniteState);
+    }
+
+    void handleRules(std::istringstream& in)
+    {
+        std::string game;
+        int rows = 0, cols = 0, k = 0;
+        if ((in >> game) && game == "infinite")
+        {
+            if (!(in >> k) || k < 1)
+            {
+                send("info string usage: rules infinite K");
+                return;
+            }
+            stop();
+            setInfiniteRules(k);
+            return;
+        }
+        int shape = SHAPE_GRID;
+        Hypergraph graph;
+        if (!(in >> rows >> cols >> k) || !parseGameShape(game, shape) || !makeGame(shape, rows, cols, k, graph))
+        {
+            send("info string usage: rules grid|torus|hex R C K (at most " + std::to_string(MAX_GAME_CELLS)
+                + " cells, K from 1 to " + std::to_string(MAX_LINE_LENGTH) + ") or rules infinite K");
+            return;
+        }
+        stop();
+        setRules(graph);
+    }
+
+    // Weights stay loaded across "rules" commands; they fit any board
+    void handleWeights(std::istringstream& in)
+    {
+        std::string path;
+        if (!std::getline(in >> std::ws, path) || path.empty())
+        {
+            send("info string usage: weights FILE|none");
+            return;
+        }
+        stop();
+
+        if (path == "none")
+            weights.reset();
+        else
+        {
+            std::shared_ptr<PatternWeights> loaded(new PatternWeights());
+            if (!loadPatternWeights(path, *loaded))
+            {
+                send("info string cannot read pattern weights from " + path);
+                return;
+            }
+            weights = loaded;
+        }
+        rules->patterns = weights;
+        search->clear();   // stored scores came from the old evaluation
+    }
+
+    template<class Rules>
+    void handlePosition(const Rules& rules, typename Rules::State& state, std::istringstream& in)
+    {
+        std::string word;
+        if (!(in >> word) || word != "startpos")
+        {
+            send("info string usage: position startpos [moves c1 c2 ...]");
+            return;
+        }
+        stop();
+
+        typename Rules::State next;
+        rules.reset(next);
+        if (in >> word)
+        {
+            if (word != "moves")
+            {
+                send("info string expected \"moves\", got " + word);
+                return;
+            }
+            std::string token;
+            while (in >> token)
+            {
+                int move = -1;
+                if (rules.isTerminal(next) || !parseMove(rules, next, token, move))
+                {
+                    send("info string illegal move " + token);
+                    return;
+                }
+                rules.makeMove(next, move);
+            }
+        }
+        state = next;
+    }
+
+    // A whole token of decimal digits naming an empty cell of the board
+    static bool parseMove(const HypergraphRules& rules, const HypergraphState& state, const std::string& token, int& move)
+    {
+        if (token.empty() || token.size() > 9 || token.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        move = atoi(token.c_str());
+        return move < rules.graph.cellCount && state.cells[move] == EMPTY_CELL;
+    }
+
+    // "x,y", each an optionally negative decimal, naming a legal cell
+    static bool parseMove(const InfiniteRules& rules, const InfiniteBoard& state, const std::string& token, int& move)
+    {
+        size_t comma = token.find(',');
+        int x = 0, y = 0;
+        if (comma == std::string::npos || !parseCoordinate(token.substr(0, comma), x)
+            || !parseCoordinate(token.substr(comma + 1), y) || !rules.isLegal(state, x, y))
+            return false;
+        move = infiniteMove(x, y);
+        return true;
+    }
+
+    static bool parseCoordinate(const std::string& text, int& value)
+    {
+        size_t digits = text.size() > 0 && text[0] == '-' ? 1 : 0;
+        if (text.size() == digits || text.size() > digits + 6 || text.find_first_not_of("0123456789", digits) != std::string::npos)
+            return false;
+        value = atoi(text.c_str());
+        return true;
+    }
+
+    static std::string moveText(const HypergraphRules&, int move)
+    {
+        return std::to_string(move);
+    }
+
+    static std::string moveText(const InfiniteRules&, int move)
+    {
+        return std::to_string(infiniteMoveX(move)) + "," + std::to_string(infiniteMoveY(move));
+    }
+
+    void handleGo(std::istringstream& in)
+    {
+        SearchLimits limits;
+        int lineCount = 1;
+        bool infinite = false;
+        std::string word;
+        while (in >> word)
+        {
+            if (word == "depth")
+                in >> limits.maxDepth;
+            else if (word == "nodes")
+                in >> limits.maxNodes;
+            else if (word == "movetime")
+                in >> limits.maxTimeMs;
+            else if (word == "infinite")
+            {
+                limits = SearchLimits();
+                infinite = true;
+            }
+            else if (word == "multipv")
+                in >> lineCount;
+            else
+                send("info string ignoring go option " + word);
+        }
+
+        stop();
+        if (infiniteRules)
+            startSearch(*infiniteRules, *infiniteSearch, infiniteState, limits, lineCount, infinite);
+        else
+            startSearch(*rules, *search, state, limits, lineCount, infinite);
+    }
+
+    template<class Rules>
+    void startSearch(const Rules& rules, AlphaBetaSearch<Rules>& search, const typename Rules::State& root,
+        SearchLimits limits, int lineCount, bool infinite)
+    {
+        if (rules.isTerminal(root))
+        {
+            send("bestmove none");
+            return;
+        }
+
+        stopSearch = false;
+        limits.stop = &stopSearch;
+        searchThread = std::thread(&Engine::runSearch<Rules>, this, &rules, &search, root, limits, lineCount, infinite);
+    }
+
+    // After "go infinite" the best move is held back until "stop", even if
+    // the search ends first (a proven result or the end of the game)
+    template<class Rules>
+    void runSearch(const Rules* rules, AlphaBetaSearch<Rules>* search, typename Rules::State root, SearchLimits limits,
+        int lineCount, bool infinite)
+    {
+        int bestMove = searchBestMove(rules, search, root, limits, lineCount);
+        while (infinite && !stopSearch.load())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        send("bestmove " + moveText(*rules, bestMove));
+    }
+
+    template<class Rules>
+    int searchBestMove(const Rules* rules, AlphaBetaSearch<Rules>* search, typename Rules::State& root,
+        SearchLimits& limits, int lineCount)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (lineCount > 1)
+        {
+            MultiPvResult result = search->searchMultiPv(root, limits, lineCount, [&](const MultiPvResult& iteration)
+            {
+                for (size_t i = 0; i < iteration.lines.size(); i++)
+                {
+                    const MultiPvLine& line = iteration.lines[i];
+                    sendInfo(*rules, start, iteration.depth, (int)i + 1, line.score, iteration.nodes, line.pv);
+                }
+            });
+            return result.lines[0].move;
+        }
+
+        limits.onIteration = [this, rules, start](const SearchResult& result)
+        {
+            sendInfo(*rules, start, result.depth, 0, result.score, result.nodes, result.pv);
+        };
+        return search->search(root, limits).bestMove;
+    }
+
+    // multiPv 0 leaves out the multipv field
+    template<class Rules>
+    void sendInfo(const Rules& rules, std::chrono::steady_clock::time_point start, int depth, int multiPv, int score,
+        uint64_t nodes, const std::vector<int>& pv)
+    {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::ostringstream out;
+        out << "info depth " << depth;
+        if (multiPv > 0)
+            out << " multipv " << multiPv;
+        out << " score " << formatScore(score)
+            << " nodes " << nodes
+            << " nps " << (uint64_t)(ms > 0.0 ? nodes * 1000.0 / ms : 0.0)
+            << " time " << (int64_t)ms << " pv";
+        for (size_t i = 0; i < pv.size(); i++)
+            out << " " << moveText(rules, pv[i]);
+        send(out.str());
+    }
+
+    // Blocks until the running search (if any) has printed its bestmove
+    void stop()
+    {
+        if (!searchThread.joinable())
+            return;
+        stopSearch = true;
+        searchThread.join();
+    }
+
+    static std::string formatScore(int score)
+    {
+        if (score >= SCORE_WIN_BOUND)
+            return "win " + std::to_string(SCORE_WIN - score);
+        if (score <= -SCORE_WIN_BOUND)
+            return "loss " + std::to_string(SCORE_WIN + score);
+        return "cp " + std::to_string(score);
+    }
+
+    void printBoard()
+    {
+        if (infiniteRules)
+        {
+            printInfiniteBoard();
+            return;
+        }
+
+        const Hypergraph& graph = rules->graph;
+        std::ostringstream out;
+        for (int row = 0; row < graph.rows; row++)
+        {
+            out << "info string ";
+            for (int col = 0; col < graph.cols; col++)
+            {
+                int8_t cell = state.cells[row * graph.cols + col];
+                out << (cell == 0 ? 'X' : cell == 1 ? 'O' : '.');
+            }
+            if (row + 1 < graph.rows)
+                out << "\n";
+        }
+        send(out.str());
+    }
+
+    // The rectangle around the stones, after a line giving its corners
+    void printInfiniteBoard()
+    {
+        const InfiniteBoard& board = infiniteState;
+        if (board.chunks.empty())
+        {
+            send("info string empty board, first move 0,0");
+            return;
+        }
+
+        int minX = INT_MAX, minY = INT_MAX, maxX = INT_MIN, maxY = INT_MIN;
+        for (ChunkMap::const_iterator it = board.chunks.begin(); it != board.chunks.end(); ++it)
+        {
+            int baseX = chunkKeyX(it->first) * CHUNK_SIZE;
+            int baseY = chunkKeyY(it->first) * CHUNK_SIZE;
+            for (int row = 0; row < CHUNK_SIZE; row++)
+            {
+                unsigned int bits = it->second.rows[0][row] | it->second.rows[1][row];
+                if (bits == 0)
+                    continue;
+                minX = std::min(minX, baseX + __builtin_ctz(bits));
+                maxX = std::max(maxX, baseX + 31 - __builtin_clz(bits));
+                minY = std::min(minY, baseY + row);
+                maxY = std::max(maxY, baseY + row);
+            }
+        }
+
+        std::ostringstream out;
+        out << "info string x " << minX << ".." << maxX << ", y " << minY << ".." << maxY;
+        for (int y = minY; y <= maxY; y++)
+        {
+            out << "\ninfo string ";
+            for (int x = minX; x <= maxX; x++)
+            {
+                char stone = infiniteCellAt(board, x, y);
+                out << (stone == ' ' ? '.' : stone);
+            }
+        }
+        send(out.str());
+    }
+
+    void send(const std::string& line)
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << line << std::endl;
+    }
+
+    std::shared_ptr<const PatternWeights> weights;
+    std::unique_ptr<HypergraphRules> rules;
+    std::unique_ptr<AlphaBetaSearch<HypergraphRules> > search;
+    HypergraphState state;
+
+    // Set while "rules infinite K" is in force
+    std::unique_ptr<InfiniteRules> infiniteRules;
+    std::unique_ptr<AlphaBetaSearch<InfiniteRules> > infiniteSearch;
+    InfiniteBoard infiniteState;
+
+    std::thread searchThread;
+    std::atomic<bool> stopSearch;
+    std::mutex outputMutex;   // info lines come from the search thread
+};
+
+int main()
+{
+    std::ios::sync_with_stdio(false);
+
+    Engine engine;
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        if (!engine.handle(line))
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "hypergraph.h"
+
+#include <algorithm>
+#include <set>
+
+Hypergraph buildHypergraph(int cellCount, const std::vector<std::vector<int>>& lines)
+{
+    Hypergraph graph;
+    graph.cellCount = cellCount;
+
+    std::set<std::vector<int>> seen;
+    std::vector<int> degree(cellCount, 0);
+
+    graph.lineStart.push_back(0);
+    for (size_t l = 0; l < lines.size(); l++)
+    {
+        std::vector<int> key = lines[l];
+        std::sort(key.begin(), key.end());
+        if (key.empty() || !seen.insert(key).second)
+            continue;
+
+        for (size_t i = 0; i < lines[l].size(); i++)
+        {
+            graph.lineCells.push_back(lines[l][i]);
+            degree[lines[l][i]]++;
+        }
+        graph.lineStart.push_back((int)graph.lineCells.size());
+    }
+    graph.lineCount = (int)graph.lineStart.size() - 1;
+
+    // Transpose into cell -> lines
+    graph.cellStart.assign(cellCount + 1, 0);
+    for (int c = 0; c < cellCount; c++)
+        graph.cellStart[c + 1] = graph.cellStart[c] + degree[c];
+
+    graph.cellLines.resize(graph.lineCells.size());
+    std::vector<int> fill(graph.cellStart.begin(), graph.cellStart.end() - 1);
+    for (int l = 0; l < graph.lineCount; l++)
+    {
+        for (int i = graph.lineStart[l]; i < graph.lineStart[l + 1]; i++)
+            graph.cellLines[fill[graph.lineCells[i]]++] = l;
+    }
+
+    return graph;
+}
+
+// Collects every k-long run along the given directions. With `wrap` set,
+// runs continue across the edges instead of stopping at them.
+static Hypergraph makeDirectionalGame(int shape, int rows, int cols, int k, const int (*directions)[2], int directionCount,
+    bool wrap)
+{
+    std::vector<std::vector<int>> lines;
+
+    for (int r = 0; r < rows; r++)
+    {
+        for (int c = 0; c < cols; c++)
+        {
+            for (int d = 0; d < directionCount; d++)
+            {
+                std::vector<int> line;
+                for (int i = 0; i < k; i++)
+                {
+                    int row = r + i * directions[d][0];
+                    int col = c + i * directions[d][1];
+                    if (wrap)
+                    {
+                        row = ((row % rows) + rows) % rows;
+                        col = ((col % cols) + cols) % cols;
+                    }
+                    else if (row < 0 || row >= rows || col < 0 || col >= cols)
+                        break;
+                    line.push_back(row * cols + col);
+                }
+
+                // A wrapped run longer than the board would revisit cells
+                std::vector<int> unique = line;
+                std::sort(unique.begin(), unique.end());
+                if ((int)line.size() == k && std::unique(unique.begin(), unique.end()) == unique.end())
+                    lines.push_back(line);
+            }
+        }
+    }
+
+    Hypergraph graph = buildHypergraph(rows * cols, lines);
+    graph.rows = rows;
+    graph.cols = cols;
+    graph.shape = shape;
+    graph.k = k;
+    return graph;
+}
+
+Hypergraph makeGridGame(int rows, int cols, int k)
+{
+    static const int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    return makeDirectionalGame(SHAPE_GRID, rows, cols, k, directions, 4, false);
+}
+
+Hypergraph makeTorusGame(int rows, int cols, int k)
+{
+    static const int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    return makeDirectionalGame(SHAPE_TORUS, rows, cols, k, directions, 4, true);
+}
+
+Hypergraph makeHexGame(int rows, int cols, int k)
+{
+    // Axial coordinates: each cell touches six neighbours along three axes
+    static const int directions[3][2] = {{0, 1}, {1, 0}, {1, -1}};
+    return makeDirectionalGame(SHAPE_HEX, rows, cols, k, directions, 3, false);
+}
+
+bool parseGameShape(const std::string& name, int& shape)
+{
+    static const char* const names[3] = {"grid", "torus", "hex"};
+    for (int i = 0; i < 3; i++)
+    {
+        if (name == names[i])
+        {
+            shape = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool makeGame(int shape, int rows, int cols, int k, Hypergraph& graph)
+{
+    // Divided rather than multiplied, so huge sizes cannot overflow
+    if (rows < 1 || cols < 1 || rows > MAX_GAME_CELLS / cols || k < 1 || k > MAX_LINE_LENGTH)
+        return false;
+
+    if (shape == SHAPE_GRID)
+        graph = makeGridGame(rows, cols, k);
+    else if (shape == SHAPE_TORUS)
+        graph = makeTorusGame(rows, cols, k);
+    else if (shape == SHAPE_HEX)
+        graph = makeHexGame(rows, cols, k);
+    else
+        return false;
+    return true;
+}
+
+void lineStateReset(LineState& state, const Hypergraph& graph)
+{
+    int words = (graph.lineCount + 63) / 64;
+
+    for (int p = 0; p < 2; p++)
+    {
+        state.counts[p].assign(graph.lineCount, 0);
+        state.live[p].assign(words, ~0ULL);
+
+        // Keep the padding bits of the last word clear
+        if (graph.lineCount % 64 != 0)
+            state.live[p][words - 1] = (1ULL << (graph.lineCount % 64)) - 1;
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A positional game is a set of cells plus a set of winning lines; a player
+// wins by owning every cell of one line. Square grids, tori, hex grids and
+// custom shapes only differ in how the lines are built.
+//
+// Both directions of the incidence relation are stored in CSR form: the
+// cells of line l are lineCells[lineStart[l] .. lineStart[l + 1]), the lines
+// through cell c are cellLines[cellStart[c] .. cellStart[c + 1]).
+struct Hypergraph
+{
+    int cellCount = 0;
+    int lineCount = 0;
+
+    std::vector<int> lineStart;
+    std::vector<int> lineCells;
+    std::vector<int> cellStart;
+    std::vector<int> cellLines;
+
+    // Layout used to map cells to the screen (cell = row * cols + col)
+    int rows = 0;
+    int cols = 0;
+
+    // What the board builders made: a GameShape and the line length, or -1
+    // and 0 for a graph built from a custom line list
+    int shape = -1;
+    int k = 0;
+};
+
+// Longest line a game may have: LineState counts stones per line in a byte
+const int MAX_LINE_LENGTH = 255;
+
+// Most cells a game may have: the search stores moves as int16
+const int MAX_GAME_CELLS = 32767;
+
+// Board shapes makeGame builds. The values match TTT_GAME_* in the C API.
+enum GameShape
+{
+    SHAPE_GRID = 0,
+    SHAPE_TORUS = 1,
+    SHAPE_HEX = 2
+};
+
+// "grid", "torus" or "hex". Returns false for any other name.
+bool parseGameShape(const std::string& name, int& shape);
+
+// Builds the CSR arrays from an explicit list of lines, each of at most
+// MAX_LINE_LENGTH cells. Duplicate lines (same cell set) are dropped, the
+// order of cells inside a line is kept.
+Hypergraph buildHypergraph(int cellCount, const std::vector<std::vector<int>>& lines);
+
+// k-in-a-row on a rows x cols grid (rows, columns and both diagonals)
+Hypergraph makeGridGame(int rows, int cols, int k);
+
+// Same as makeGridGame, but lines wrap around both edges
+Hypergraph makeTorusGame(int rows, int cols, int k);
+
+// k-in-a-row along the three axes of a rows x cols rhombus of hex cells
+Hypergraph makeHexGame(int rows, int cols, int k);
+
+// The checked way in: builds the game of the given GameShape, or returns
+// false if the shape is unknown, rows or cols are below 1, the board has more
+// than MAX_GAME_CELLS cells or k is outside 1 .. MAX_LINE_LENGTH
+bool makeGame(int shape, int rows, int cols, int k, Hypergraph& graph);
+
+inline int lineLength(const Hypergraph& graph, int line)
+{
+    return graph.lineStart[line + 1] - graph.lineStart[line];
+}
+
+// Per-game bookkeeping over the lines of a hypergraph. A line is live for a
+// player while the opponent has no stone on it; live[p] holds one bit per
+// line and is kept up to date by lineStatePlace / lineStateRemove.
+struct LineState
+{
+    std::vector<uint8_t> counts[2];
+    std::vector<uint64_t> live[2];
+};
+
+void lineStateReset(LineState& state, const Hypergraph& graph);
+
+// Records a stone of `player` (0 or 1) on `cell`. Returns the line the stone
+// completed, or -1 if it did not complete any.
+inline int lineStatePlace(LineState& state, const Hypergraph& graph, int cell, int player)
+{
+    int opponent = 1 - player;
+    int completed = -1;
+
+    for (int i = graph.cellStart[cell]; i < graph.cellStart[cell + 1]; i++)
+    {
+        int line = graph.cellLines[i];
+        int count = ++state.counts[player][line];
+        if (count == 1)
+            state.live[opponent][line >> 6] &= ~(1ULL << (line & 63));
+        if (count == lineLength(graph, line) && completed == -1)
+            completed = line;
+    }
+    return completed;
+}
+
+// Undoes lineStatePlace for the same cell and player
+inline void lineStateRemove(LineState& state, const Hypergraph& graph, int cell, int player)
+{
+    int opponent = 1 - player;
+
+    for (int i = graph.cellStart[cell]; i < graph.cellStart[cell + 1]; i++)
+    {
+        int line = graph.cellLines[i];
+        if (--state.counts[player][line] == 0)
+            state.live[opponent][line >> 6] |= 1ULL << (line & 63);
+    }
+}
+
+inline bool lineIsLive(const LineState& state, int player, int line)
+{
+    return (state.live[player][line >> 6] >> (line & 63)) & 1;
+}
+
+// True while `player` has a live line it could still fill with at most
+// `movesLeft` more stones. When this is false for both players the game is
+// a forced draw, however many empty cells are left.
+inline bool lineStateCanWin(const LineState& state, const Hypergraph& graph, int player, int movesLeft)
+{
+    const std::vector<uint64_t>& live = state.live[player];
+    const std::vector<uint8_t>& counts = state.counts[player];
+
+    for (size_t w = 0; w < live.size(); w++)
+    {
+        uint64_t bits = live[w];
+        while (bits)
+        {
+            int line = (int)(w * 64) + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (lineLength(graph, line) - counts[line] <= movesLeft)
+                return true;
+        }
+    }
+    return false;
+}
+
+// Forced-draw test for the position after a move, with `toMove` next to play
+inline bool lineStateIsDrawn(const LineState& state, const Hypergraph& graph, int toMove, int emptyCells)
+{
+    int toMoveLeft = (emptyCells + 1) / 2;
+    int otherLeft = emptyCells / 2;
+    return !lineStateCanWin(state, graph, toMove, toMoveLeft) && !lineStateCanWin(state, graph, 1 - toMove, otherLeft);
+}
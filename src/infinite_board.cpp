@@ -0,0 +1,295 @@
+#include "infinite_board.h"
+
+#include <cstdlib>
+#include <cstring>
+
+static int playerIndex(char player)
+{
+    return player == 'X' ? 0 : 1;
+}
+
+// Key of one stone for InfiniteBoard::hash: the coordinates and owner mixed
+// with splitmix64's finaliser, since there is no table to draw from
+static uint64_t stoneKey(int x, int y, int player)
+{
+    uint64_t z = ((uint64_t)(uint32_t)x << 32 | (uint32_t)y) ^ (player ? 0xd1342543de82ef95ULL : 0);
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static const Chunk* findChunk(const ChunkMap& chunks, int x, int y)
+{
+    ChunkMap::const_iterator it = chunks.find(chunkKey(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT));
+    return it == chunks.end() ? nullptr : &it->second;
+}
+
+static bool chunkHasStone(const Chunk& chunk, int player, int x, int y)
+{
+    return (chunk.rows[player][y & (CHUNK_SIZE - 1)] >> (x & (CHUNK_SIZE - 1))) & 1;
+}
+
+void infiniteReset(InfiniteBoard& board, int winLength)
+{
+    board.chunks.clear();
+    board.winLength = winLength;
+    board.currentPlayer = 'X';
+    board.gameOver = false;
+    board.moveCount = 0;
+    board.hasWinner = false;
+    board.winX1 = board.winY1 = board.winX2 = board.winY2 = 0;
+    board.hash = 0;
+}
+
+char infiniteCellAt(const InfiniteBoard& board, int x, int y)
+{
+    const Chunk* chunk = findChunk(board.chunks, x, y);
+    if (chunk == nullptr)
+        return ' ';
+    if (chunkHasStone(*chunk, 0, x, y))
+        return 'X';
+    if (chunkHasStone(*chunk, 1, x, y))
+        return 'O';
+    return ' ';
+}
+
+bool infinitePlace(InfiniteBoard& board, int x, int y)
+{
+    if (board.gameOver || infiniteCellAt(board, x, y) != ' ')
+        return false;
+
+    uint64_t key = chunkKey(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+    ChunkMap::iterator it = board.chunks.find(key);
+    if (it == board.chunks.end())
+    {
+        Chunk empty;
+        memset(&empty, 0, sizeof(empty));
+        it = board.chunks.emplace(key, empty).first;
+    }
+
+    Chunk& chunk = it->second;
+    chunk.rows[playerIndex(board.currentPlayer)][y & (CHUNK_SIZE - 1)] |= (uint16_t)(1u << (x & (CHUNK_SIZE - 1)));
+    chunk.stoneCount++;
+    board.moveCount++;
+    board.hash ^= stoneKey(x, y, playerIndex(board.currentPlayer));
+
+    if (!infiniteCheckWinAt(board, x, y))
+        board.currentPlayer = (board.currentPlayer == 'X') ? 'O' : 'X';
+    return true;
+}
+
+void infiniteUndo(InfiniteBoard& board, int x, int y)
+{
+    char owner = infiniteCellAt(board, x, y);
+    if (owner == ' ')
+        return;
+
+    ChunkMap::iterator it = board.chunks.find(chunkKey(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT));
+    Chunk& chunk = it->second;
+    chunk.rows[playerIndex(owner)][y & (CHUNK_SIZE - 1)] &= (uint16_t)~(1u << (x & (CHUNK_SIZE - 1)));
+
+    // Drop chunks that became empty so long games do not leak memory
+    if (--chunk.stoneCount == 0)
+        board.chunks.erase(it);
+
+    board.moveCount--;
+    board.hash ^= stoneKey(x, y, playerIndex(owner));
+    board.currentPlayer = owner;
+    board.gameOver = false;
+    board.hasWinner = false;
+}
+
+bool infiniteCheckWinAt(InfiniteBoard& board, int x, int y)
+{
+    char player = infiniteCellAt(board, x, y);
+    if (player == ' ')
+        return false;
+
+    static const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+
+    for (int d = 0; d < 4; d++)
+    {
+        int dx = directions[d][0];
+        int dy = directions[d][1];
+
+        // Walk outwards in both directions, stopping after winLength stones
+        int forward = 0;
+        while (forward < board.winLength && infiniteCellAt(board, x + (forward + 1) * dx, y + (forward + 1) * dy) == player)
+            forward++;
+
+        int backward = 0;
+        while (backward < board.winLength && infiniteCellAt(board, x - (backward + 1) * dx, y - (backward + 1) * dy) == player)
+            backward++;
+
+        if (forward + backward + 1 >= board.winLength)
+        {
+            board.gameOver = true;
+            board.hasWinner = true;
+            board.winX1 = x - backward * dx;
+            board.winY1 = y - backward * dy;
+            board.winX2 = x + forward * dx;
+            board.winY2 = y + forward * dy;
+            return true;
+        }
+    }
+    return false;
+}
+
+void infiniteLegalMoves(const InfiniteBoard& board, int radius, std::vector<std::pair<int, int>>& moves)
+{
+    moves.clear();
+
+    if (board.chunks.empty())
+    {
+        moves.push_back(std::make_pair(0, 0));
+        return;
+    }
+
+    // Candidate cells are collected as bits in their own chunk map, which
+    // dedupes neighbourhoods shared by several stones.
+    ChunkMap candidates;
+    candidates.reserve(board.chunks.size() * 2);
+
+    for (ChunkMap::const_iterator it = board.chunks.begin(); it != board.chunks.end(); ++it)
+    {
+        int baseX = chunkKeyX(it->first) * CHUNK_SIZE;
+        int baseY = chunkKeyY(it->first) * CHUNK_SIZE;
+        const Chunk& chunk = it->second;
+
+        for (int row = 0; row < CHUNK_SIZE; row++)
+        {
+            unsigned int occupied = chunk.rows[0][row] | chunk.rows[1][row];
+            while (occupied)
+            {
+                int col = __builtin_ctz(occupied);
+                occupied &= occupied - 1;
+
+                for (int dy = -radius; dy <= radius; dy++)
+                {
+                    for (int dx = -radius; dx <= radius; dx++)
+                    {
+                        int x = baseX + col + dx;
+                        int y = baseY + row + dy;
+                        uint64_t key = chunkKey(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+                        ChunkMap::iterator cand = candidates.find(key);
+                        if (cand == candidates.end())
+                        {
+                            Chunk empty;
+                            memset(&empty, 0, sizeof(empty));
+                            cand = candidates.emplace(key, empty).first;
+                        }
+                        cand->second.rows[0][y & (CHUNK_SIZE - 1)] |= (uint16_t)(1u << (x & (CHUNK_SIZE - 1)));
+                    }
+                }
+            }
+        }
+    }
+
+    for (ChunkMap::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+    {
+        int cx = chunkKeyX(it->first);
+        int cy = chunkKeyY(it->first);
+        const Chunk* stones = findChunk(board.chunks, cx * CHUNK_SIZE, cy * CHUNK_SIZE);
+
+        for (int row = 0; row < CHUNK_SIZE; row++)
+        {
+            unsigned int bits = it->second.rows[0][row];
+            if (stones != nullptr)
+                bits &= ~(unsigned int)(stones->rows[0][row] | stones->rows[1][row]);
+
+            while (bits)
+            {
+                int col = __builtin_ctz(bits);
+                bits &= bits - 1;
+                moves.push_back(std::make_pair(cx * CHUNK_SIZE + col, cy * CHUNK_SIZE + row));
+            }
+        }
+    }
+}
+
+int InfiniteRules::generateMoves(const State& state, int* moves) const
+{
+    // One buffer per thread, as the rules are shared by every search
+    static thread_local std::vector<std::pair<int, int>> cells;
+    infiniteLegalMoves(state, radius, cells);
+
+    int count = 0;
+    for (size_t i = 0; i < cells.size(); i++)
+    {
+        if (abs(cells[i].first) <= INFINITE_COORD_LIMIT && abs(cells[i].second) <= INFINITE_COORD_LIMIT)
+            moves[count++] = infiniteMove(cells[i].first, cells[i].second);
+    }
+    return count;
+}
+
+bool InfiniteRules::isLegal(const State& state, int x, int y) const
+{
+    if (abs(x) > INFINITE_COORD_LIMIT || abs(y) > INFINITE_COORD_LIMIT || infiniteCellAt(state, x, y) != ' ')
+        return false;
+    if (state.chunks.empty())
+        return x == 0 && y == 0;
+
+    for (int dy = -radius; dy <= radius; dy++)
+    {
+        for (int dx = -radius; dx <= radius; dx++)
+        {
+            if (infiniteCellAt(state, x + dx, y + dy) != ' ')
+                return true;
+        }
+    }
+    return false;
+}
+
+int InfiniteRules::evaluate(const State& state) const
+{
+    static const int runWeight[8] = {0, 1, 4, 16, 64, 256, 1024, 4096};
+    static const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+    int side = toMove(state);
+    int score = 0;
+
+    for (ChunkMap::const_iterator it = state.chunks.begin(); it != state.chunks.end(); ++it)
+    {
+        int baseX = chunkKeyX(it->first) * CHUNK_SIZE;
+        int baseY = chunkKeyY(it->first) * CHUNK_SIZE;
+
+        for (int player = 0; player < 2; player++)
+        {
+            char stone = player == 0 ? 'X' : 'O';
+            for (int row = 0; row < CHUNK_SIZE; row++)
+            {
+                unsigned int bits = it->second.rows[player][row];
+                while (bits)
+                {
+                    int x = baseX + __builtin_ctz(bits);
+                    int y = baseY + row;
+                    bits &= bits - 1;
+
+                    // Score each run once, from its first stone
+                    for (int d = 0; d < 4; d++)
+                    {
+                        int dx = directions[d][0];
+                        int dy = directions[d][1];
+                        char before = infiniteCellAt(state, x - dx, y - dy);
+                        if (before == stone)
+                            continue;
+
+                        int length = 1;
+                        while (length < winLength && infiniteCellAt(state, x + length * dx, y + length * dy) == stone)
+                            length++;
+                        int openEnds = (before == ' ') + (infiniteCellAt(state, x + length * dx, y + length * dy) == ' ');
+
+                        int value = runWeight[length < 7 ? length : 7] * openEnds;
+                        score += player == side ? value : -value;
+                    }
+                }
+            }
+        }
+    }
+
+    if (score >= SCORE_WIN_BOUND)
+        return SCORE_WIN_BOUND - 1;
+    if (score <= -SCORE_WIN_BOUND)
+        return -(SCORE_WIN_BOUND - 1);
+    return score;
+}
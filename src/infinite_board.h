@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "rules.h"
+
+// Infinite board: stones are stored in 16x16 chunks kept in a hash map,
+// so only the parts of the plane that were actually played on use memory.
+const int CHUNK_SIZE = 16;
+const int CHUNK_SHIFT = 4;
+
+struct Chunk
+{
+    // One 16-bit row mask per chunk row, for each player (0 = X, 1 = O)
+    uint16_t rows[2][CHUNK_SIZE];
+    int stoneCount;
+};
+
+// Map key of the chunk at chunk coordinates (cx, cy), and back
+inline uint64_t chunkKey(int cx, int cy)
+{
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+}
+
+inline int chunkKeyX(uint64_t key)
+{
+    return (int32_t)(uint32_t)(key >> 32);
+}
+
+inline int chunkKeyY(uint64_t key)
+{
+    return (int32_t)(uint32_t)key;
+}
+
+struct ChunkKeyHash
+{
+    size_t operator()(uint64_t key) const
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return (size_t)key;
+    }
+};
+
+typedef std::unordered_map<uint64_t, Chunk, ChunkKeyHash> ChunkMap;
+
+struct InfiniteBoard
+{
+    ChunkMap chunks;
+    int winLength = 5;
+    char currentPlayer = 'X';
+    bool gameOver = false;
+    int moveCount = 0;
+
+    // Endpoints of the winning run, valid when gameOver and a player won
+    int winX1 = 0, winY1 = 0, winX2 = 0, winY2 = 0;
+    bool hasWinner = false;
+
+    // Zobrist-style key of the stones, kept up to date by place and undo
+    uint64_t hash = 0;
+};
+
+void infiniteReset(InfiniteBoard& board, int winLength);
+char infiniteCellAt(const InfiniteBoard& board, int x, int y);
+
+// Places the current player's stone at (x, y), checks for a win around the
+// new stone and passes the turn. Returns false if the move is not legal.
+bool infinitePlace(InfiniteBoard& board, int x, int y);
+
+// Takes back the stone at (x, y) and gives the turn back to its owner.
+void infiniteUndo(InfiniteBoard& board, int x, int y);
+
+// Checks the four lines through (x, y) only, so the cost does not depend on
+// how many stones are on the board.
+bool infiniteCheckWinAt(InfiniteBoard& board, int x, int y);
+
+// Empty cells within `radius` (Chebyshev distance) of any stone. On an empty
+// board the only candidate is the origin.
+void infiniteLegalMoves(const InfiniteBoard& board, int radius, std::vector<std::pair<int, int>>& moves);
+
+// Moves of InfiniteRules are ints with x and y packed into 15 bits each, so
+// coordinates are limited to +-INFINITE_COORD_LIMIT, far more room than any
+// game gets to use
+const int INFINITE_COORD_LIMIT = 16383;
+const int INFINITE_MOVE_RADIUS = 2;
+const int INFINITE_MAX_STONES = 1000;
+
+inline int infiniteMove(int x, int y)
+{
+    return (x + INFINITE_COORD_LIMIT + 1) << 15 | (y + INFINITE_COORD_LIMIT + 1);
+}
+
+inline int infiniteMoveX(int move)
+{
+    return (move >> 15) - (INFINITE_COORD_LIMIT + 1);
+}
+
+inline int infiniteMoveY(int move)
+{
+    return (move & 32767) - (INFINITE_COORD_LIMIT + 1);
+}
+
+// k-in-a-row on the unbounded board as a rules policy (see rules.h), so the
+// alpha-beta search and the engine can play it. Legal moves are the empty
+// cells within `radius` of a stone, and the game is drawn once `maxStones`
+// stones are down, which also bounds the number of legal moves.
+struct InfiniteRules
+{
+    typedef InfiniteBoard State;
+    typedef int32_t TableMove;
+
+    int winLength;
+    int radius;
+    int maxStones;
+
+    explicit InfiniteRules(int winLength, int radius = INFINITE_MOVE_RADIUS, int maxStones = INFINITE_MAX_STONES)
+        : winLength(winLength), radius(radius), maxStones(maxStones)
+    {
+    }
+
+    // Each stone has at most (2r + 1)^2 - 1 empty neighbours
+    int maxMoves() const
+    {
+        int perStone = (2 * radius + 1) * (2 * radius + 1) - 1;
+        return perStone * maxStones > 1 ? perStone * maxStones : 1;
+    }
+
+    // The game is drawn once maxStones are down
+    int maxPlies(const State& state) const
+    {
+        return maxStones > state.moveCount ? maxStones - state.moveCount : 0;
+    }
+
+    void reset(State& state) const
+    {
+        infiniteReset(state, winLength);
+    }
+
+    int generateMoves(const State& state, int* moves) const;
+
+    // True if (x, y) is one of the moves generateMoves would return
+    bool isLegal(const State& state, int x, int y) const;
+
+    void makeMove(State& state, int move) const
+    {
+        infinitePlace(state, infiniteMoveX(move), infiniteMoveY(move));
+    }
+
+    void unmakeMove(State& state, int move) const
+    {
+        infiniteUndo(state, infiniteMoveX(move), infiniteMoveY(move));
+    }
+
+    bool isTerminal(const State& state) const
+    {
+        return state.gameOver || state.moveCount >= maxStones;
+    }
+
+    int status(const State& state) const
+    {
+        // The winner keeps the turn in infinitePlace
+        if (state.hasWinner)
+            return state.currentPlayer == 'X' ? GAME_X_WINS : GAME_O_WINS;
+        return state.moveCount >= maxStones ? GAME_DRAW : GAME_ONGOING;
+    }
+
+    int toMove(const State& state) const
+    {
+        int player = state.currentPlayer == 'X' ? 0 : 1;
+        return state.hasWinner ? 1 - player : player;
+    }
+
+    uint64_t hash(const State& state) const
+    {
+        return state.hash;
+    }
+
+    // Open runs of each side's stones, worth more the longer they are
+    int evaluate(const State& state) const;
+};
@@ -4,6 +4,9 @@
 #include <vector>
 #include <cmath>
 #include <string>
+#include "ai_worker.h"
+#include "analysis_worker.h"
+#include "rules.h"
 
 // Game constants
 const unsigned int SCR_WIDTH = 800;
@@ -11,23 +14,59 @@ const unsigned int SCR_HEIGHT = 800;
 const int BOARD_SIZE = 3;
 
 // Game state
-char board[BOARD_SIZE][BOARD_SIZE] = {{' ', ' ', ' '}, {' ', ' ', ' '}, {' ', ' ', ' '}};
-char currentPlayer = 'X';
+HypergraphRules gameRules(makeGridGame(BOARD_SIZE, BOARD_SIZE, BOARD_SIZE));
+HypergraphState gameState;
 bool gameOver = false;
-int moveCount = 0;
+
+// AI opponent (press A to toggle); it plays O and thinks on its own thread
+const int AI_PLAYER = 1;
+const int AI_THINK_TIME_MS = 1000;
+AiWorker aiWorker(gameRules);
+bool aiEnabled = false;
+unsigned int gameGeneration = 0;
+
+// Analysis overlay (press H to toggle): every empty cell is tinted green or
+// red by how good it is for the side to move, refined in the background
+AnalysisWorker analysisWorker(gameRules);
+bool heatmapEnabled = false;
+unsigned int analysisGeneration = 0;
+CellValues heatmapValues;
+unsigned int heatmapProgram, heatmapVAO, heatmapQuadVBO, heatmapInstanceVBO;
+int heatmapInstanceCount = 0;
 
 // Winning line state
 int winRow1 = -1, winCol1 = -1, winRow2 = -1, winCol2 = -1;
 
+// Board drawing: the grid, button and piece shapes are uploaded once at
+// startup; pieces are drawn instanced from per-cell offsets, which are
+// rewritten (with the winning line) only when the board changes
+struct BoardRenderer
+{
+    unsigned int program;
+    int colorLocation;
+
+    unsigned int shapeVAO, shapeVBO;
+    int gridFirst, buttonFirst, buttonCount, xFirst, oFirst, oCount;
+
+    unsigned int pieceVAO[2], pieceInstanceVBO;   // X and O
+    int pieceCount[2];
+
+    unsigned int winLineVAO, winLineVBO;
+    bool dirty;
+};
+BoardRenderer boardRenderer;
+
 // Button state
 bool buttonHovered = false;
 
-// Shader sources
+// Shader sources. aOffset is only fed per instance for pieces; elsewhere the
+// attribute array is disabled and reads as (0, 0).
 const char *vertexShaderSource = "#version 330 core\n"
     "layout (location = 0) in vec2 aPos;\n"
+    "layout (location = 1) in vec2 aOffset;\n"
     "void main()\n"
     "{\n"
-    "   gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);\n"
+    "   gl_Position = vec4(aPos + aOffset, 0.0, 1.0);\n"
     "}\0";
 
 const char *fragmentShaderSource = "#version 330 core\n"
@@ -38,19 +77,48 @@ const char *fragmentShaderSource = "#version 330 core\n"
     "   FragColor = vec4(ourColor, 1.0);\n"
     "}\n\0";
 
+// Heatmap quads: a unit quad per vertex, offset and colour per instance
+const char *heatmapVertexShaderSource = "#version 330 core\n"
+    "layout (location = 0) in vec2 aPos;\n"
+    "layout (location = 1) in vec2 aOffset;\n"
+    "layout (location = 2) in vec3 aColor;\n"
+    "uniform vec2 cellSize;\n"
+    "out vec3 tint;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = vec4(aOffset + aPos * cellSize, 0.0, 1.0);\n"
+    "   tint = aColor;\n"
+    "}\0";
+
+const char *heatmapFragmentShaderSource = "#version 330 core\n"
+    "in vec3 tint;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = vec4(tint, 1.0);\n"
+    "}\n\0";
+
 // Function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void cursor_position_callback(GLFWwindow* window, double xpos, double ypos);
-void renderBoard(unsigned int shaderProgram);
-void drawX(float x, float y, unsigned int shaderProgram);
-void drawO(float x, float y, unsigned int shaderProgram);
-void drawGrid(unsigned int shaderProgram);
-void drawWinningLine(int row1, int col1, int row2, int col2, unsigned int shaderProgram);
-void drawButton(unsigned int shaderProgram);
+void initBoardRenderer();
+void updateBoardGeometry();
+void drawPieces();
+void drawGrid();
+void drawWinningLine();
+void drawButton();
+unsigned int buildShaderProgram(const char* vertexSource, const char* fragmentSource);
+void initHeatmap();
+void updateHeatmap();
+void drawHeatmap();
+void requestAnalysis();
 void checkWin();
 void resetGame();
+void requestAiMove();
+void applyAiMoves();
 
 int main()
 {
@@ -72,6 +140,7 @@ int main()
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetCursorPosCallback(window, cursor_position_callback);
+    glfwSetKeyCallback(window, key_callback);
 
     // Load OpenGL functions
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -80,65 +149,70 @@ int main()
         return -1;
     }
 
-    // Build and compile shaders
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
+    // Build shaders and the buffers that live for the whole run
+    initBoardRenderer();
+    initHeatmap();
 
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    resetGame();
+    aiWorker.start();
+    analysisWorker.start();
 
     // Main render loop
     while (!glfwWindowShouldClose(window))
     {
+        // Pick up moves the AI finished since the last frame
+        applyAiMoves();
+        updateHeatmap();
+        updateBoardGeometry();
+
         processInput(window);
 
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        glUseProgram(shaderProgram);
+        // Under the grid and the pieces
+        drawHeatmap();
 
-        drawGrid(shaderProgram);
-        renderBoard(shaderProgram);
+        glUseProgram(boardRenderer.program);
+
+        drawGrid();
+        drawPieces();
 
         // Draw the winning line if there is a win
         if (gameOver && winRow1 != -1)
-            drawWinningLine(winRow1, winCol1, winRow2, winCol2, shaderProgram);
+            drawWinningLine();
 
         // Draw the restart button
-        drawButton(shaderProgram);
+        drawButton();
 
         // Update window title if game is over
         if (gameOver)
         {
-            if (moveCount == BOARD_SIZE * BOARD_SIZE)
+            if (winRow1 == -1)
                 glfwSetWindowTitle(window, "Tic-Tac-Toe - Draw! Click Restart or press R to restart.");
             else
             {
                 std::string title = "Tic-Tac-Toe - Player ";
-                title += currentPlayer;
+                title += (gameState.status == GAME_X_WINS) ? 'X' : 'O';
                 title += " Wins! Click Restart or press R to restart.";
                 glfwSetWindowTitle(window, title.c_str());
             }
         }
+        else if (aiEnabled && gameState.toMove == AI_PLAYER)
+        {
+            glfwSetWindowTitle(window, "Tic-Tac-Toe - AI is thinking...");
+        }
         else
         {
-            glfwSetWindowTitle(window, "Tic-Tac-Toe");
+            glfwSetWindowTitle(window, aiEnabled ? "Tic-Tac-Toe - vs AI" : "Tic-Tac-Toe");
         }
 
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    aiWorker.shutdown();
+    analysisWorker.shutdown();
     glfwTerminate();
     return 0;
 }
@@ -147,8 +221,27 @@ void processInput(GLFWwindow *window)
 {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
+}
 
-    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if (key == GLFW_KEY_A && action == GLFW_PRESS)
+    {
+        aiEnabled = !aiEnabled;
+        if (aiEnabled)
+            requestAiMove();
+        else
+            aiWorker.cancel();
+    }
+
+    if (key == GLFW_KEY_H && action == GLFW_PRESS)
+    {
+        heatmapEnabled = !heatmapEnabled;
+        requestAnalysis();
+    }
+
+    // Once per press: polling would reset every frame while R is held
+    if (key == GLFW_KEY_R && action == GLFW_PRESS)
         resetGame();
 }
 
@@ -182,7 +275,8 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
             return;
         }
         
-        if (!gameOver)
+        // Clicks on the board are ignored while the AI has the move
+        if (!gameOver && !(aiEnabled && gameState.toMove == AI_PLAYER))
         {
             double xpos, ypos;
             glfwGetCursorPos(window, &xpos, &ypos);
@@ -196,40 +290,26 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
             int col = xpos / cellWidth;
             int row = ypos / cellHeight;
 
-            if (row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE && board[row][col] == ' ')
+            if (row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE && gameState.cells[row * BOARD_SIZE + col] == EMPTY_CELL)
             {
-                board[row][col] = currentPlayer;
-                moveCount++;
+                gameRules.makeMove(gameState, row * BOARD_SIZE + col);
                 checkWin();
-                if (!gameOver) currentPlayer = (currentPlayer == 'X') ? 'O' : 'X';
+                requestAiMove();
+                requestAnalysis();
             }
         }
     }
 }
 
-void renderBoard(unsigned int shaderProgram)
+// Vertices of every fixed shape, in one buffer: the grid, the restart
+// button and one X and one O around (0, 0)
+void initBoardRenderer()
 {
-    float cellWidth = 2.0f / BOARD_SIZE;
-    float cellHeight = 2.0f / BOARD_SIZE;
-
-    for (int i = 0; i < BOARD_SIZE; i++)
-    {
-        for (int j = 0; j < BOARD_SIZE; j++)
-        {
-            float centerX = -1.0f + cellWidth / 2 + j * cellWidth;
-            float centerY = 1.0f - cellHeight / 2 - i * cellHeight;
-
-            if (board[i][j] == 'X')
-                drawX(centerX, centerY, shaderProgram);
-            else if (board[i][j] == 'O')
-                drawO(centerX, centerY, shaderProgram);
-        }
-    }
-}
+    BoardRenderer& r = boardRenderer;
+    r.program = buildShaderProgram(vertexShaderSource, fragmentShaderSource);
+    r.colorLocation = glGetUniformLocation(r.program, "ourColor");
 
-void drawGrid(unsigned int shaderProgram)
-{
-    float lineVertices[] = {
+    float gridVertices[] = {
         // Vertical lines
         -0.33f, -1.0f,
         -0.33f,  1.0f,
@@ -242,136 +322,6 @@ void drawGrid(unsigned int shaderProgram)
          1.0f,  0.33f
     };
 
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(lineVertices), lineVertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
-    glUniform3f(vertexColorLocation, 0.0f, 0.0f, 0.0f);
-
-    glDrawArrays(GL_LINES, 0, 8);
-
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-}
-
-void drawX(float x, float y, unsigned int shaderProgram)
-{
-    float size = 0.2f;
-    float vertices[] = {
-        x - size, y - size,
-        x + size, y + size,
-        x - size, y + size,
-        x + size, y - size
-    };
-
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
-    glUniform3f(vertexColorLocation, 1.0f, 0.0f, 0.0f); // Red
-
-    glLineWidth(4.0f);
-    glDrawArrays(GL_LINES, 0, 4);
-    glLineWidth(1.0f);
-
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-}
-
-void drawO(float x, float y, unsigned int shaderProgram)
-{
-    const int segments = 32;
-    float radius = 0.2f;
-    std::vector<float> vertices;
-
-    for (int i = 0; i < segments; i++)
-    {
-        float angle = 2.0f * 3.1415926f * float(i) / float(segments);
-        vertices.push_back(x + radius * cosf(angle));
-        vertices.push_back(y + radius * sinf(angle));
-
-        angle = 2.0f * 3.1415926f * float(i+1) / float(segments);
-        vertices.push_back(x + radius * cosf(angle));
-        vertices.push_back(y + radius * sinf(angle));
-    }
-
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
-    glUniform3f(vertexColorLocation, 0.0f, 0.0f, 1.0f); // Blue
-
-    glLineWidth(4.0f);
-    glDrawArrays(GL_LINES, 0, segments * 2);
-    glLineWidth(1.0f);
-
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-}
-
-void drawWinningLine(int row1, int col1, int row2, int col2, unsigned int shaderProgram)
-{
-    float cellWidth = 2.0f / BOARD_SIZE;
-    float cellHeight = 2.0f / BOARD_SIZE;
-
-    float x1 = -1.0f + cellWidth / 2 + col1 * cellWidth;
-    float y1 = 1.0f - cellHeight / 2 - row1 * cellHeight;
-    float x2 = -1.0f + cellWidth / 2 + col2 * cellWidth;
-    float y2 = 1.0f - cellHeight / 2 - row2 * cellHeight;
-
-    float vertices[] = {
-        x1, y1,
-        x2, y2
-    };
-
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
-    glUniform3f(vertexColorLocation, 0.0f, 1.0f, 0.0f); // Green
-
-    glLineWidth(5.0f); // Make it thick
-    glDrawArrays(GL_LINES, 0, 2);
-    glLineWidth(1.0f); // Reset to default
-
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-}
-
-void drawButton(unsigned int shaderProgram)
-{
     // Button coordinates (bottom right corner)
     float buttonVertices[] = {
         // Button background (rectangle)
@@ -420,118 +370,382 @@ void drawButton(unsigned int shaderProgram)
         0.975f, -0.82f, 0.975f, -0.85f // T vertical
     };
 
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+    float size = 0.2f;
+    float xVertices[] = {
+        -size, -size,
+         size,  size,
+        -size,  size,
+         size, -size
+    };
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(buttonVertices), buttonVertices, GL_STATIC_DRAW);
+    std::vector<float> vertices(gridVertices, gridVertices + sizeof(gridVertices) / sizeof(float));
+    r.gridFirst = 0;
+    r.buttonFirst = (int)vertices.size() / 2;
+    r.buttonCount = (int)(sizeof(buttonVertices) / sizeof(float)) / 2;
+    vertices.insert(vertices.end(), buttonVertices, buttonVertices + sizeof(buttonVertices) / sizeof(float));
+    r.xFirst = (int)vertices.size() / 2;
+    vertices.insert(vertices.end(), xVertices, xVertices + sizeof(xVertices) / sizeof(float));
 
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    // O: a circle of line segments
+    const int segments = 32;
+    float radius = 0.2f;
+    r.oFirst = (int)vertices.size() / 2;
+    r.oCount = segments * 2;
+    for (int i = 0; i < segments; i++)
+    {
+        float angle = 2.0f * 3.1415926f * float(i) / float(segments);
+        vertices.push_back(radius * cosf(angle));
+        vertices.push_back(radius * sinf(angle));
 
-    // Draw button background
-    int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
-    if (buttonHovered)
-        glUniform3f(vertexColorLocation, 0.8f, 0.8f, 0.8f); // Light gray when hovered
-    else
-        glUniform3f(vertexColorLocation, 0.9f, 0.9f, 0.9f); // Light gray
+        angle = 2.0f * 3.1415926f * float(i+1) / float(segments);
+        vertices.push_back(radius * cosf(angle));
+        vertices.push_back(radius * sinf(angle));
+    }
 
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    glGenVertexArrays(1, &r.shapeVAO);
+    glGenBuffers(1, &r.shapeVBO);
+    glBindVertexArray(r.shapeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, r.shapeVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
 
-    // Draw button border
-    glUniform3f(vertexColorLocation, 0.0f, 0.0f, 0.0f); // Black
-    glDrawArrays(GL_LINE_LOOP, 0, 4);
+    // Pieces: the X or O shape per vertex, the cell centre per instance. The
+    // instance buffer has room for every cell as an X, then as an O.
+    int cellCount = gameRules.graph.cellCount;
+    glGenVertexArrays(2, r.pieceVAO);
+    glGenBuffers(1, &r.pieceInstanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, r.pieceInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, 2 * cellCount * 2 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    for (int player = 0; player < 2; player++)
+    {
+        glBindVertexArray(r.pieceVAO[player]);
+        glBindBuffer(GL_ARRAY_BUFFER, r.shapeVBO);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, r.pieceInstanceVBO);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)(player * cellCount * 2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+        r.pieceCount[player] = 0;
+    }
 
-    // Draw "RESTART" text (each letter is 2-5 line segments)
-    glUniform3f(vertexColorLocation, 0.0f, 0.0f, 0.0f); // Black
-    glLineWidth(2.0f);
-    
-    // Draw each letter (each letter is composed of line segments)
-    // R (4 lines)
-    glDrawArrays(GL_LINES, 4, 8);
-    // E (4 lines)
-    glDrawArrays(GL_LINES, 12, 8);
-    // S (5 lines)
-    glDrawArrays(GL_LINES, 20, 10);
-    // T (2 lines)
-    glDrawArrays(GL_LINES, 30, 4);
-    // A (5 lines)
-    glDrawArrays(GL_LINES, 34, 10);
-    // R (4 lines)
-    glDrawArrays(GL_LINES, 44, 8);
-    // T (2 lines)
-    glDrawArrays(GL_LINES, 52, 4);
-    
-    glLineWidth(1.0f);
+    glGenVertexArrays(1, &r.winLineVAO);
+    glGenBuffers(1, &r.winLineVBO);
+    glBindVertexArray(r.winLineVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, r.winLineVBO);
+    glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
 
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    glBindVertexArray(0);
+    r.dirty = true;
 }
 
-void checkWin()
+// Rewrites the piece instances and the winning line after the board changed
+void updateBoardGeometry()
 {
-    // Check rows
+    BoardRenderer& r = boardRenderer;
+    if (!r.dirty)
+        return;
+    r.dirty = false;
+
+    float cellWidth = 2.0f / BOARD_SIZE;
+    float cellHeight = 2.0f / BOARD_SIZE;
+    int cellCount = gameRules.graph.cellCount;
+    std::vector<float> centres[2];
+
     for (int i = 0; i < BOARD_SIZE; i++)
     {
-        if (board[i][0] != ' ' && board[i][0] == board[i][1] && board[i][1] == board[i][2])
+        for (int j = 0; j < BOARD_SIZE; j++)
         {
-            gameOver = true;
-            winRow1 = i; winCol1 = 0;
-            winRow2 = i; winCol2 = 2;
-            return;
+            int cell = gameState.cells[i * BOARD_SIZE + j];
+            if (cell == EMPTY_CELL)
+                continue;
+            centres[cell].push_back(-1.0f + cellWidth / 2 + j * cellWidth);
+            centres[cell].push_back(1.0f - cellHeight / 2 - i * cellHeight);
         }
     }
 
-    // Check columns
-    for (int j = 0; j < BOARD_SIZE; j++)
+    glBindBuffer(GL_ARRAY_BUFFER, r.pieceInstanceVBO);
+    for (int player = 0; player < 2; player++)
     {
-        if (board[0][j] != ' ' && board[0][j] == board[1][j] && board[1][j] == board[2][j])
+        r.pieceCount[player] = (int)centres[player].size() / 2;
+        if (r.pieceCount[player] > 0)
         {
-            gameOver = true;
-            winRow1 = 0; winCol1 = j;
-            winRow2 = 2; winCol2 = j;
-            return;
+            glBufferSubData(GL_ARRAY_BUFFER, player * cellCount * 2 * sizeof(float),
+                centres[player].size() * sizeof(float), centres[player].data());
         }
     }
 
-    // Check diagonals
-    if (board[0][0] != ' ' && board[0][0] == board[1][1] && board[1][1] == board[2][2])
+    if (winRow1 != -1)
     {
-        gameOver = true;
-        winRow1 = 0; winCol1 = 0;
-        winRow2 = 2; winCol2 = 2;
-        return;
+        float vertices[] = {
+            -1.0f + cellWidth / 2 + winCol1 * cellWidth, 1.0f - cellHeight / 2 - winRow1 * cellHeight,
+            -1.0f + cellWidth / 2 + winCol2 * cellWidth, 1.0f - cellHeight / 2 - winRow2 * cellHeight
+        };
+        glBindBuffer(GL_ARRAY_BUFFER, r.winLineVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
     }
+}
+
+void drawGrid()
+{
+    BoardRenderer& r = boardRenderer;
+    glBindVertexArray(r.shapeVAO);
+    glUniform3f(r.colorLocation, 0.0f, 0.0f, 0.0f);
+    glDrawArrays(GL_LINES, r.gridFirst, 8);
+}
+
+void drawPieces()
+{
+    BoardRenderer& r = boardRenderer;
+    glLineWidth(4.0f);
 
-    if (board[0][2] != ' ' && board[0][2] == board[1][1] && board[1][1] == board[2][0])
+    if (r.pieceCount[0] > 0)
     {
-        gameOver = true;
-        winRow1 = 0; winCol1 = 2;
-        winRow2 = 2; winCol2 = 0;
-        return;
+        glBindVertexArray(r.pieceVAO[0]);
+        glUniform3f(r.colorLocation, 1.0f, 0.0f, 0.0f); // Red
+        glDrawArraysInstanced(GL_LINES, r.xFirst, 4, r.pieceCount[0]);
+    }
+    if (r.pieceCount[1] > 0)
+    {
+        glBindVertexArray(r.pieceVAO[1]);
+        glUniform3f(r.colorLocation, 0.0f, 0.0f, 1.0f); // Blue
+        glDrawArraysInstanced(GL_LINES, r.oFirst, r.oCount, r.pieceCount[1]);
     }
 
-    // Check for draw
-    if (moveCount == BOARD_SIZE * BOARD_SIZE)
+    glLineWidth(1.0f);
+}
+
+void drawWinningLine()
+{
+    BoardRenderer& r = boardRenderer;
+    glBindVertexArray(r.winLineVAO);
+    glUniform3f(r.colorLocation, 0.0f, 1.0f, 0.0f); // Green
+
+    glLineWidth(5.0f); // Make it thick
+    glDrawArrays(GL_LINES, 0, 2);
+    glLineWidth(1.0f); // Reset to default
+}
+
+void drawButton()
+{
+    BoardRenderer& r = boardRenderer;
+    glBindVertexArray(r.shapeVAO);
+
+    // Draw button background
+    if (buttonHovered)
+        glUniform3f(r.colorLocation, 0.8f, 0.8f, 0.8f); // Light gray when hovered
+    else
+        glUniform3f(r.colorLocation, 0.9f, 0.9f, 0.9f); // Light gray
+
+    glDrawArrays(GL_TRIANGLE_FAN, r.buttonFirst, 4);
+
+    // Draw button border
+    glUniform3f(r.colorLocation, 0.0f, 0.0f, 0.0f); // Black
+    glDrawArrays(GL_LINE_LOOP, r.buttonFirst, 4);
+
+    // Draw "RESTART" text: all letter strokes in one call
+    glLineWidth(2.0f);
+    glDrawArrays(GL_LINES, r.buttonFirst + 4, r.buttonCount - 4);
+    glLineWidth(1.0f);
+
+    glBindVertexArray(0);
+}
+
+void checkWin()
+{
+    // Win and draw detection (including early draws) live in gameRules;
+    // here we only pick up the result for drawing
+    gameOver = gameRules.isTerminal(gameState);
+    winRow1 = winCol1 = winRow2 = winCol2 = -1;
+    boardRenderer.dirty = true;
+
+    if (gameState.winLine != -1)
     {
-        gameOver = true;
-        winRow1 = winCol1 = winRow2 = winCol2 = -1;
+        const Hypergraph& lines = gameRules.graph;
+        int first = lines.lineCells[lines.lineStart[gameState.winLine]];
+        int last = lines.lineCells[lines.lineStart[gameState.winLine + 1] - 1];
+
+        winRow1 = first / BOARD_SIZE; winCol1 = first % BOARD_SIZE;
+        winRow2 = last / BOARD_SIZE; winCol2 = last % BOARD_SIZE;
     }
 }
 
 void resetGame()
 {
-    for (int i = 0; i < BOARD_SIZE; i++)
+    // Moves still being computed for the old game are dropped
+    gameGeneration++;
+    aiWorker.cancel();
+
+    gameRules.reset(gameState);
+    gameOver = false;
+    winRow1 = winCol1 = winRow2 = winCol2 = -1;
+    boardRenderer.dirty = true;
+    requestAnalysis();
+}
+
+void requestAiMove()
+{
+    if (!aiEnabled || gameOver || gameState.toMove != AI_PLAYER)
+        return;
+
+    SearchLimits limits;
+    limits.maxTimeMs = AI_THINK_TIME_MS;
+    aiWorker.requestMove(gameState, gameGeneration, limits);
+}
+
+void applyAiMoves()
+{
+    AiMove move;
+    while (aiWorker.pollMove(move))
     {
-        for (int j = 0; j < BOARD_SIZE; j++)
+        if (move.generation != gameGeneration || !aiEnabled || gameOver || gameState.toMove != AI_PLAYER)
+            continue;
+        if (gameState.cells[move.move] != EMPTY_CELL)
+            continue;
+
+        gameRules.makeMove(gameState, move.move);
+        checkWin();
+        requestAnalysis();
+
+        // Keep thinking on the human's time
+        if (!gameOver)
+            aiWorker.ponder(gameState);
+    }
+}
+
+unsigned int buildShaderProgram(const char* vertexSource, const char* fragmentSource)
+{
+    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vertexSource, NULL);
+    glCompileShader(vertexShader);
+
+    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
+    glCompileShader(fragmentShader);
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return program;
+}
+
+// The heatmap buffers live for the whole run; only the per-instance data is
+// rewritten, and only when the analysis publishes new values
+void initHeatmap()
+{
+    heatmapProgram = buildShaderProgram(heatmapVertexShaderSource, heatmapFragmentShaderSource);
+
+    float quadVertices[] = {
+        -0.5f, -0.5f,
+         0.5f, -0.5f,
+         0.5f,  0.5f,
+        -0.5f,  0.5f
+    };
+
+    glGenVertexArrays(1, &heatmapVAO);
+    glGenBuffers(1, &heatmapQuadVBO);
+    glGenBuffers(1, &heatmapInstanceVBO);
+
+    glBindVertexArray(heatmapVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, heatmapQuadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Per instance: centre (x, y) and colour (r, g, b)
+    glBindBuffer(GL_ARRAY_BUFFER, heatmapInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, gameRules.graph.cellCount * 5 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(0);
+}
+
+// Picks up finished analysis (without waiting for the worker) and rebuilds
+// the instance data
+void updateHeatmap()
+{
+    if (!analysisWorker.pollValues(heatmapValues) || heatmapValues.generation != analysisGeneration)
+        return;
+
+    float cellWidth = 2.0f / BOARD_SIZE;
+    float cellHeight = 2.0f / BOARD_SIZE;
+    std::vector<float> instances;
+
+    for (int cell = 0; cell < gameRules.graph.cellCount; cell++)
+    {
+        if (!heatmapValues.valid[cell])
+            continue;
+
+        // Squash the score into [-1, 1]; forced results get the full colour
+        int score = heatmapValues.scores[cell];
+        float t = score / (fabsf((float)score) + 32.0f);
+        if (score >= SCORE_WIN_BOUND)
+            t = 1.0f;
+        else if (score <= -SCORE_WIN_BOUND)
+            t = -1.0f;
+
+        // White for an even move, towards green (good) or red (bad)
+        float r = 1.0f, g = 1.0f, b = 1.0f;
+        if (t > 0.0f)
         {
-            board[i][j] = ' ';
+            r -= 0.5f * t; b -= 0.5f * t;
         }
+        else
+        {
+            g += 0.5f * t; b += 0.5f * t;
+        }
+
+        int row = cell / BOARD_SIZE, col = cell % BOARD_SIZE;
+        instances.push_back(-1.0f + cellWidth / 2 + col * cellWidth);
+        instances.push_back(1.0f - cellHeight / 2 - row * cellHeight);
+        instances.push_back(r);
+        instances.push_back(g);
+        instances.push_back(b);
     }
-    currentPlayer = 'X';
-    gameOver = false;
-    moveCount = 0;
-    winRow1 = winCol1 = winRow2 = winCol2 = -1;
-}
\ No newline at end of file
+
+    heatmapInstanceCount = (int)(instances.size() / 5);
+    if (heatmapInstanceCount > 0)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, heatmapInstanceVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(float), instances.data());
+    }
+}
+
+void drawHeatmap()
+{
+    if (!heatmapEnabled || heatmapInstanceCount == 0)
+        return;
+
+    glUseProgram(heatmapProgram);
+    // Slightly smaller than a cell so the grid lines stay clear
+    glUniform2f(glGetUniformLocation(heatmapProgram, "cellSize"), 2.0f / BOARD_SIZE * 0.96f, 2.0f / BOARD_SIZE * 0.96f);
+    glBindVertexArray(heatmapVAO);
+    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, heatmapInstanceCount);
+    glBindVertexArray(0);
+}
+
+// Restarts the analysis for the current position; the old overlay is hidden
+// until the first values for the new one arrive
+void requestAnalysis()
+{
+    analysisGeneration++;
+    heatmapInstanceCount = 0;
+
+    if (heatmapEnabled && !gameOver)
+        analysisWorker.analyze(gameState, analysisGeneration);
+    else
+        analysisWorker.cancel();
+}
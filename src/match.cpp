@@ -0,0 +1,164 @@
+#include "match.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+bool parseEngineConfig(const std::string& spec, EngineConfig& config)
+{
+    config = EngineConfig();
+    size_t colon = spec.find(':');
+    config.name = spec.substr(0, colon);
+    if (config.name.empty())
+    {
+        std::cout << "Engine spec without a name: " << spec << std::endl;
+        return false;
+    }
+    if (colon == std::string::npos)
+        return true;
+
+    std::stringstream stream(spec.substr(colon + 1));
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (item.empty())
+            continue;
+        size_t equals = item.find('=');
+        std::string key = item.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : item.substr(equals + 1);
+
+        if (key == "depth" && !value.empty())
+            config.maxDepth = atoi(value.c_str());
+        else if (key == "nodes" && !value.empty())
+            config.maxNodes = (uint64_t)atoll(value.c_str());
+        else if (key == "movetime" && !value.empty())
+            config.moveTimeMs = atoll(value.c_str());
+        else if (key == "random")
+            config.random = true;
+        else if (key == "weights" && !value.empty())
+        {
+            std::shared_ptr<PatternWeights> weights(new PatternWeights());
+            if (!loadPatternWeights(value, *weights))
+            {
+                std::cout << "Cannot read pattern weights from " << value << std::endl;
+                return false;
+            }
+            config.weightsPath = value;
+            config.weights = weights;
+        }
+        else
+        {
+            std::cout << "Unknown engine setting '" << item << "' in " << spec << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string describeEngineConfig(const EngineConfig& config)
+{
+    if (config.random)
+        return config.name + " (random)";
+
+    std::ostringstream out;
+    out << config.name << " (depth " << config.maxDepth;
+    if (config.maxNodes != 0)
+        out << ", " << config.maxNodes << " nodes";
+    if (config.moveTimeMs != 0)
+        out << ", " << config.moveTimeMs << " ms";
+    if (config.weights)
+        out << ", weights " << config.weightsPath;
+    out << ")";
+    return out.str();
+}
+
+MatchPlayer::MatchPlayer(const HypergraphRules& rules, const EngineConfig& config)
+    : rules(rules), engineConfig(config), moves(rules.maxMoves())
+{
+    if (config.weights)
+    {
+        weightedRules.reset(new HypergraphRules(rules));
+        weightedRules->patterns = config.weights;
+    }
+    if (!config.random)
+        search.reset(new AlphaBetaSearch<HypergraphRules>(weightedRules ? *weightedRules : rules, 16));
+    seedRandom(rng, 0, 0);
+}
+
+void MatchPlayer::newGame(uint64_t seed, uint64_t stream)
+{
+    if (search)
+        search->clear();
+    seedRandom(rng, seed, stream);
+}
+
+int MatchPlayer::chooseMove(HypergraphState& state)
+{
+    if (!search)
+    {
+        int count = rules.generateMoves(state, &moves[0]);
+        result = SearchResult();
+        result.bestMove = moves[randomBelow(rng, count)];
+        result.pv.push_back(result.bestMove);
+        return result.bestMove;
+    }
+
+    SearchLimits limits;
+    limits.maxDepth = engineConfig.maxDepth;
+    limits.maxNodes = engineConfig.maxNodes;
+    limits.maxTimeMs = engineConfig.moveTimeMs;
+    result = search->search(state, limits);
+    return result.bestMove;
+}
+
+int playMatchGame(const HypergraphRules& rules, const HypergraphState& opening, MatchPlayer& x, MatchPlayer& o)
+{
+    HypergraphState state = opening;
+    while (!rules.isTerminal(state))
+    {
+        MatchPlayer& player = rules.toMove(state) == 0 ? x : o;
+        rules.makeMove(state, player.chooseMove(state));
+    }
+    return rules.status(state);
+}
+
+std::vector<HypergraphState> generateOpenings(const HypergraphRules& rules, int count, int plies, uint64_t seed,
+    int balanceDepth, int margin)
+{
+    std::vector<HypergraphState> openings;
+    std::set<uint64_t> seen;
+    AlphaBetaSearch<HypergraphRules> search(rules, 16);
+    std::vector<int> moves(rules.maxMoves());
+
+    SearchLimits limits;
+    limits.maxDepth = balanceDepth;
+
+    // Attempt a is random stream (seed, a), so the set is reproducible
+    for (uint64_t attempt = 0; (int)openings.size() < count && attempt < (uint64_t)count * 100; attempt++)
+    {
+        Xoshiro128 rng;
+        seedRandom(rng, seed, attempt);
+
+        HypergraphState state;
+        rules.reset(state);
+        for (int ply = 0; ply < plies && !rules.isTerminal(state); ply++)
+        {
+            int moveCount = rules.generateMoves(state, &moves[0]);
+            rules.makeMove(state, moves[randomBelow(rng, moveCount)]);
+        }
+        if (rules.isTerminal(state) || seen.count(state.hash))
+            continue;
+
+        if (balanceDepth > 0)
+        {
+            int score = search.search(state, limits).score;
+            if (score > margin || score < -margin)
+                continue;
+        }
+
+        seen.insert(state.hash);
+        openings.push_back(state);
+    }
+    return openings;
+}
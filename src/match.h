@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "random.h"
+#include "search.h"
+
+// One engine configuration for bot-vs-bot games, written on the command line
+// as "name:key=value,key=value", e.g. "d4:depth=4" or "fast:nodes=2000".
+// Keys: depth, nodes, movetime (ms), random (uniformly random moves),
+// weights (a pattern weight file from `train` to evaluate with).
+struct EngineConfig
+{
+    std::string name;
+    int maxDepth = 64;
+    uint64_t maxNodes = 0;
+    int64_t moveTimeMs = 0;
+    bool random = false;
+    std::string weightsPath;
+    std::shared_ptr<const PatternWeights> weights;
+};
+
+// Returns false (after printing why) on a malformed spec or an unreadable
+// weights file
+bool parseEngineConfig(const std::string& spec, EngineConfig& config);
+
+std::string describeEngineConfig(const EngineConfig& config);
+
+// Plays moves for one configuration. Keeps its own transposition table, so
+// every thread needs its own players.
+class MatchPlayer
+{
+public:
+    MatchPlayer(const HypergraphRules& rules, const EngineConfig& config);
+
+    // Call between games so results do not depend on game order
+    void newGame(uint64_t seed, uint64_t stream);
+
+    int chooseMove(HypergraphState& state);
+
+    // The full result of the last chooseMove (score is 0 for random moves)
+    const SearchResult& lastResult() const { return result; }
+
+    const EngineConfig& config() const { return engineConfig; }
+
+private:
+    const HypergraphRules& rules;
+    EngineConfig engineConfig;
+    std::unique_ptr<HypergraphRules> weightedRules;   // `rules` with the config's weights
+    std::unique_ptr<AlphaBetaSearch<HypergraphRules> > search;
+    Xoshiro128 rng;
+    std::vector<int> moves;
+    SearchResult result;
+};
+
+// Plays from `opening` to the end and returns the GameStatus
+int playMatchGame(const HypergraphRules& rules, const HypergraphState& opening, MatchPlayer& x, MatchPlayer& o);
+
+// Distinct start positions reached by `plies` random moves that a
+// depth-`balanceDepth` search scores within +-margin for the side to move.
+// Each is meant to be played twice, with colours swapped. May return fewer
+// than `count` if the board has too few balanced positions.
+std::vector<HypergraphState> generateOpenings(const HypergraphRules& rules, int count, int plies, uint64_t seed,
+    int balanceDepth, int margin);
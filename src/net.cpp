@@ -0,0 +1,262 @@
+#include "net.h"
+
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int SocketLength;
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef socklen_t SocketLength;
+#endif
+
+bool netStartup()
+{
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+    {
+        std::cout << "WSAStartup failed" << std::endl;
+        return false;
+    }
+#else
+    // A worker vanishing mid-send should be an error code, not a signal
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    return true;
+}
+
+void netClose(NetSocket socket)
+{
+    if (socket == NET_INVALID_SOCKET)
+        return;
+#ifdef _WIN32
+    closesocket((SOCKET)socket);
+#else
+    close((int)socket);
+#endif
+}
+
+// Results go out in large batches, requests in tiny ones that should not
+// wait for Nagle's algorithm
+static void setNoDelay(NetSocket socket)
+{
+    int one = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+}
+
+NetSocket netListen(const std::string& host, int port)
+{
+    // IPv4 only: netAccept reports peers as sockaddr_in
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &found) != 0)
+    {
+        std::cout << "Cannot resolve bind address " << host << std::endl;
+        return NET_INVALID_SOCKET;
+    }
+    sockaddr_in address;
+    memcpy(&address, found->ai_addr, sizeof(address));
+    freeaddrinfo(found);
+    address.sin_port = htons((uint16_t)port);
+
+    NetSocket listener = (NetSocket)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == NET_INVALID_SOCKET)
+    {
+        std::cout << "Cannot create a socket" << std::endl;
+        return NET_INVALID_SOCKET;
+    }
+
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&one, sizeof(one));
+
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0)
+    {
+        std::cout << "Cannot listen on " << host << ":" << port << std::endl;
+        netClose(listener);
+        return NET_INVALID_SOCKET;
+    }
+    return listener;
+}
+
+NetSocket netAccept(NetSocket listener, std::string& peer)
+{
+    sockaddr_in address;
+    SocketLength length = sizeof(address);
+    NetSocket socket = (NetSocket)accept(listener, (sockaddr*)&address, &length);
+    if (socket == NET_INVALID_SOCKET)
+        return NET_INVALID_SOCKET;
+
+    char host[INET_ADDRSTRLEN] = "?";
+    inet_ntop(AF_INET, &address.sin_addr, host, sizeof(host));
+    peer = std::string(host) + ":" + std::to_string(ntohs(address.sin_port));
+    setNoDelay(socket);
+    return socket;
+}
+
+NetSocket netConnect(const std::string& address)
+{
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos)
+        return NET_INVALID_SOCKET;
+    std::string host = address.substr(0, colon), port = address.substr(colon + 1);
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0)
+        return NET_INVALID_SOCKET;
+
+    NetSocket result = NET_INVALID_SOCKET;
+    for (addrinfo* entry = found; entry != nullptr && result == NET_INVALID_SOCKET; entry = entry->ai_next)
+    {
+        NetSocket candidate = (NetSocket)socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+        if (candidate == NET_INVALID_SOCKET)
+            continue;
+        if (connect(candidate, entry->ai_addr, (SocketLength)entry->ai_addrlen) == 0)
+            result = candidate;
+        else
+            netClose(candidate);
+    }
+    freeaddrinfo(found);
+
+    if (result != NET_INVALID_SOCKET)
+        setNoDelay(result);
+    return result;
+}
+
+bool netSendAll(NetSocket socket, const void* data, size_t size)
+{
+    const char* bytes = (const char*)data;
+    while (size > 0)
+    {
+        int chunk = size > (1u << 30) ? (1 << 30) : (int)size;
+        int sent = (int)send(socket, bytes, chunk, 0);
+        if (sent <= 0)
+            return false;
+        bytes += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+int netRecvSome(NetSocket socket, void* data, size_t size)
+{
+    int chunk = size > (1u << 30) ? (1 << 30) : (int)size;
+    int received = (int)recv(socket, (char*)data, chunk, 0);
+    return received < 0 ? -1 : received;
+}
+
+bool netRecvAll(NetSocket socket, void* data, size_t size)
+{
+    char* bytes = (char*)data;
+    while (size > 0)
+    {
+        int received = netRecvSome(socket, bytes, size);
+        if (received <= 0)
+            return false;
+        bytes += received;
+        size -= received;
+    }
+    return true;
+}
+
+bool netWaitReadable(const std::vector<NetSocket>& sockets, int timeoutMs, std::vector<bool>& ready)
+{
+    fd_set readable;
+    FD_ZERO(&readable);
+    NetSocket highest = 0;
+    for (size_t i = 0; i < sockets.size(); i++)
+    {
+        FD_SET(sockets[i], &readable);
+        if (sockets[i] > highest)
+            highest = sockets[i];
+    }
+
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    int count = select((int)highest + 1, &readable, nullptr, nullptr, &timeout);
+    if (count < 0)
+        return false;
+
+    ready.assign(sockets.size(), false);
+    for (size_t i = 0; i < sockets.size(); i++)
+        ready[i] = FD_ISSET(sockets[i], &readable) != 0;
+    return true;
+}
+
+void netPutU32(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+void netPutU64(std::vector<uint8_t>& out, uint64_t value)
+{
+    netPutU32(out, (uint32_t)value);
+    netPutU32(out, (uint32_t)(value >> 32));
+}
+
+uint32_t netGetU32(const uint8_t* data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+uint64_t netGetU64(const uint8_t* data)
+{
+    return (uint64_t)netGetU32(data) | ((uint64_t)netGetU32(data + 4) << 32);
+}
+
+bool netSendMessage(NetSocket socket, uint8_t type, const std::vector<uint8_t>& payload)
+{
+    std::vector<uint8_t> header;
+    netPutU32(header, (uint32_t)payload.size());
+    header.push_back(type);
+    return netSendAll(socket, header.data(), header.size())
+        && (payload.empty() || netSendAll(socket, payload.data(), payload.size()));
+}
+
+bool netRecvMessage(NetSocket socket, NetMessage& message)
+{
+    uint8_t header[NET_MESSAGE_HEADER_SIZE];
+    if (!netRecvAll(socket, header, sizeof(header)))
+        return false;
+    uint32_t size = netGetU32(header);
+    if (size > NET_MAX_MESSAGE_SIZE)
+        return false;
+    message.type = header[4];
+    message.payload.resize(size);
+    return size == 0 || netRecvAll(socket, message.payload.data(), size);
+}
+
+int netTakeMessage(std::vector<uint8_t>& buffer, NetMessage& message)
+{
+    if (buffer.size() < NET_MESSAGE_HEADER_SIZE)
+        return 0;
+    uint32_t size = netGetU32(buffer.data());
+    if (size > NET_MAX_MESSAGE_SIZE)
+        return -1;
+    if (buffer.size() < NET_MESSAGE_HEADER_SIZE + size)
+        return 0;
+
+    message.type = buffer[4];
+    message.payload.assign(buffer.begin() + NET_MESSAGE_HEADER_SIZE, buffer.begin() + NET_MESSAGE_HEADER_SIZE + size);
+    buffer.erase(buffer.begin(), buffer.begin() + NET_MESSAGE_HEADER_SIZE + size);
+    return 1;
+}
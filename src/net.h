@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minimal blocking TCP over Winsock or BSD sockets, just enough for the
+// distributed self-play coordinator and its workers
+
+typedef intptr_t NetSocket;      // SOCKET on Windows, a descriptor elsewhere
+const NetSocket NET_INVALID_SOCKET = -1;
+
+// Call once before any other net function (WSAStartup on Windows)
+bool netStartup();
+
+// Listens on the IPv4 address or host name `host` ("0.0.0.0" for every
+// interface). Returns NET_INVALID_SOCKET (after printing why) on failure.
+NetSocket netListen(const std::string& host, int port);
+
+NetSocket netAccept(NetSocket listener, std::string& peer);
+
+// `address` is "host:port". Returns NET_INVALID_SOCKET on failure.
+NetSocket netConnect(const std::string& address);
+
+void netClose(NetSocket socket);
+
+bool netSendAll(NetSocket socket, const void* data, size_t size);
+bool netRecvAll(NetSocket socket, void* data, size_t size);
+
+// Reads whatever has arrived, up to `size` bytes. Returns the byte count, 0
+// once the peer has closed the connection, or -1 on error.
+int netRecvSome(NetSocket socket, void* data, size_t size);
+
+// Waits up to `timeoutMs` for any of `sockets` to become readable (or
+// closed) and sets `ready` accordingly. Returns false on error.
+bool netWaitReadable(const std::vector<NetSocket>& sockets, int timeoutMs, std::vector<bool>& ready);
+
+// Messages: uint32 payload size, uint8 type, payload; little-endian
+const size_t NET_MESSAGE_HEADER_SIZE = 5;
+const uint32_t NET_MAX_MESSAGE_SIZE = 256u << 20;
+
+struct NetMessage
+{
+    uint8_t type = 0;
+    std::vector<uint8_t> payload;
+};
+
+bool netSendMessage(NetSocket socket, uint8_t type, const std::vector<uint8_t>& payload);
+bool netRecvMessage(NetSocket socket, NetMessage& message);
+
+// Takes one whole message off the front of `buffer` if it has arrived.
+// Returns -1 on a malformed header, 1 if a message was taken, 0 otherwise.
+int netTakeMessage(std::vector<uint8_t>& buffer, NetMessage& message);
+
+// Little-endian payload builders and readers
+void netPutU32(std::vector<uint8_t>& out, uint32_t value);
+void netPutU64(std::vector<uint8_t>& out, uint64_t value);
+uint32_t netGetU32(const uint8_t* data);
+uint64_t netGetU64(const uint8_t* data);
@@ -0,0 +1,98 @@
+#include "options.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+bool parseOptions(int argc, char** argv, int first, Options& options)
+{
+    for (int i = first; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.size() < 3 || arg.compare(0, 2, "--") != 0)
+        {
+            std::cout << "Unexpected argument: " << arg << std::endl;
+            return false;
+        }
+
+        std::string name = arg.substr(2);
+        if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0)
+            options.values[name] = argv[++i];
+        else
+            options.values[name] = "";
+    }
+    return true;
+}
+
+bool hasOption(const Options& options, const std::string& name)
+{
+    return options.values.count(name) != 0;
+}
+
+std::string getOption(const Options& options, const std::string& name, const std::string& fallback)
+{
+    std::map<std::string, std::string>::const_iterator it = options.values.find(name);
+    return it == options.values.end() ? fallback : it->second;
+}
+
+long long getIntOption(const Options& options, const std::string& name, long long fallback)
+{
+    std::map<std::string, std::string>::const_iterator it = options.values.find(name);
+    return it == options.values.end() || it->second.empty() ? fallback : atoll(it->second.c_str());
+}
+
+double getDoubleOption(const Options& options, const std::string& name, double fallback)
+{
+    std::map<std::string, std::string>::const_iterator it = options.values.find(name);
+    return it == options.values.end() || it->second.empty() ? fallback : atof(it->second.c_str());
+}
+
+bool makeGameFromOptions(const Options& options, Hypergraph& graph)
+{
+    std::string game = getOption(options, "game", "grid");
+    long long rows = getIntOption(options, "rows", 3);
+    long long cols = getIntOption(options, "cols", rows);
+    long long k = getIntOption(options, "k", rows < cols ? rows : cols);
+
+    // Read as long long so huge values cannot wrap into range as ints
+    int shape = SHAPE_GRID;
+    bool fitsInt = rows >= 1 && rows <= MAX_GAME_CELLS && cols >= 1 && cols <= MAX_GAME_CELLS && k >= 1
+        && k <= MAX_LINE_LENGTH;
+    if (!parseGameShape(game, shape) || !fitsInt || !makeGame(shape, (int)rows, (int)cols, (int)k, graph))
+    {
+        std::cout << "Expected --game grid|torus|hex, --rows and --cols >= 1 with at most " << MAX_GAME_CELLS
+            << " cells in all, and --k from 1 to " << MAX_LINE_LENGTH << std::endl;
+        return false;
+    }
+    return true;
+}
+
+TaskPool& taskPoolFromOptions(const Options& options)
+{
+    PinMode pin = PIN_NONE;
+    std::string pinText = getOption(options, "pin", "none");
+    if (!parsePinMode(pinText, pin))
+        std::cout << "Unknown --pin " << pinText << " (expected none, compact or spread), not pinning" << std::endl;
+    setSharedTaskPoolConfig((int)getIntOption(options, "threads", 0), pin);
+    return sharedTaskPool();
+}
+
+// Applies a comma-separated list of cell indices to the start position
+bool applyMoveList(const HypergraphRules& rules, HypergraphState& state, const std::string& list)
+{
+    std::stringstream stream(list);
+    std::string token;
+    while (std::getline(stream, token, ','))
+    {
+        if (token.empty())
+            continue;
+        int cell = atoi(token.c_str());
+        if (cell < 0 || cell >= rules.graph.cellCount || state.cells[cell] != EMPTY_CELL || rules.isTerminal(state))
+        {
+            std::cout << "Illegal move in --moves: " << token << std::endl;
+            return false;
+        }
+        rules.makeMove(state, cell);
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include "rules.h"
+#include "task_pool.h"
+
+// Command-line options of the form --name value or --flag
+struct Options
+{
+    std::map<std::string, std::string> values;
+};
+
+// Parses argv[first..argc). Returns false (after printing why) on a stray
+// positional argument.
+bool parseOptions(int argc, char** argv, int first, Options& options);
+
+bool hasOption(const Options& options, const std::string& name);
+std::string getOption(const Options& options, const std::string& name, const std::string& fallback);
+long long getIntOption(const Options& options, const std::string& name, long long fallback);
+double getDoubleOption(const Options& options, const std::string& name, double fallback);
+
+// Builds the board selected by --game grid|torus|hex, --rows, --cols, --k
+// (see makeGame for the limits). Defaults to the 3x3 game from the window.
+// Returns false (after printing why) on a bad board.
+bool makeGameFromOptions(const Options& options, Hypergraph& graph);
+
+// The shared task pool, started with --threads workers (default: one per
+// hardware thread) placed by --pin none|compact|spread
+TaskPool& taskPoolFromOptions(const Options& options);
+
+// Plays a comma-separated list of cell indices (--moves 4,0,8) on `state`.
+// Returns false (after printing why) on an illegal move.
+bool applyMoveList(const HypergraphRules& rules, HypergraphState& state, const std::string& list);
@@ -0,0 +1,53 @@
+#include "packed_state.h"
+
+// Built at compile time, so the tables are ready before any static
+// initialiser could use them
+static constexpr PackedStateTables buildPackedStateTables()
+{
+    PackedStateTables tables = {};
+    uint32_t power = 1;
+    for (int chunk = 0; chunk < 2; chunk++)
+    {
+        uint32_t bitPowers[8] = {};
+        for (int bit = 0; bit < 8; bit++, power *= 3)
+            bitPowers[bit] = power;
+        for (int byte = 0; byte < 256; byte++)
+        {
+            uint32_t value = 0;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                if (byte >> bit & 1)
+                    value += bitPowers[bit];
+            }
+            tables.digits[chunk][byte] = value;
+        }
+    }
+
+    for (int number = 0; number < 6561; number++)
+    {
+        int rest = number;
+        int x = 0, o = 0;
+        for (int bit = 0; bit < 8; bit++, rest /= 3)
+        {
+            if (rest % 3 == 1)
+                x |= 1 << bit;
+            else if (rest % 3 == 2)
+                o |= 1 << bit;
+        }
+        tables.masks[number] = (uint16_t)(x | o << 8);
+    }
+    return tables;
+}
+
+constexpr PackedStateTables packedStateTables = buildPackedStateTables();
+
+uint32_t packState(const HypergraphState& state)
+{
+    uint32_t masks[2] = {0, 0};
+    for (size_t cell = 0; cell < state.cells.size(); cell++)
+    {
+        if (state.cells[cell] != EMPTY_CELL)
+            masks[state.cells[cell]] |= 1u << cell;
+    }
+    return packState(masks[0], masks[1], state.toMove);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "census.h"
+#include "rules.h"
+
+// Positions on boards of up to 16 cells (3x3, 4x4) packed into 32 bits, for
+// keeping very many of them in memory. The cells form a base-3 number
+// (digit 0 empty, 1 X, 2 O, cell 0 least significant), which stays below
+// 3^16 < 2^26, and bit 31 holds the side to move. Every position has
+// exactly one code, so a code is also a collision-free hash key. To index a
+// table directly (2 * 3^9 entries for 3x3), use packedStateIndex.
+//
+// Packing and unpacking go through tables of 8 cells at a time, so each
+// takes a handful of lookups and no loop over the cells.
+const int PACKED_STATE_MAX_CELLS = 16;
+const uint32_t PACKED_STATE_TO_MOVE = 0x80000000u;
+
+struct PackedStateTables
+{
+    // Base-3 value of the cells set in one byte of a mask, per byte position
+    uint32_t digits[2][256];
+    // The 8 cells of a base-3 number below 3^8: X mask in the low byte, O
+    // mask in the high byte
+    uint16_t masks[6561];
+};
+
+extern const PackedStateTables packedStateTables;
+
+inline uint32_t packState(uint32_t xMask, uint32_t oMask, int toMove)
+{
+    const PackedStateTables& t = packedStateTables;
+    uint32_t x = t.digits[0][xMask & 255] + t.digits[1][(xMask >> 8) & 255];
+    uint32_t o = t.digits[0][oMask & 255] + t.digits[1][(oMask >> 8) & 255];
+    return (x + 2 * o) | (toMove ? PACKED_STATE_TO_MOVE : 0);
+}
+
+inline void unpackState(uint32_t code, uint32_t& xMask, uint32_t& oMask, int& toMove)
+{
+    const PackedStateTables& t = packedStateTables;
+    uint32_t digits = code & ~PACKED_STATE_TO_MOVE;
+    uint16_t low = t.masks[digits % 6561];
+    uint16_t high = t.masks[digits / 6561];
+    xMask = (low & 255) | (uint32_t)(high & 255) << 8;
+    oMask = (low >> 8) | (uint32_t)(high >> 8) << 8;
+    toMove = code & PACKED_STATE_TO_MOVE ? 1 : 0;
+}
+
+// 3^cellCount, the number of board codes without the side to move
+inline uint32_t packedBoardCodes(int cellCount)
+{
+    uint32_t codes = 1;
+    for (int cell = 0; cell < cellCount; cell++)
+        codes *= 3;
+    return codes;
+}
+
+// Dense index below 2 * boardCodes (see packedBoardCodes): O-to-move
+// positions follow all X-to-move ones
+inline uint32_t packedStateIndex(uint32_t code, uint32_t boardCodes)
+{
+    return (code & ~PACKED_STATE_TO_MOVE) + (code & PACKED_STATE_TO_MOVE ? boardCodes : 0);
+}
+
+// The state's board (at most PACKED_STATE_MAX_CELLS cells) and side to move
+uint32_t packState(const HypergraphState& state);
+
+// Smallest code over all symmetric images of the position, so positions
+// that only differ by a rotation or reflection share one key
+inline uint32_t packCanonicalState(const BoardSymmetries& symmetries, uint32_t xMask, uint32_t oMask, int toMove)
+{
+    uint32_t best = ~0u;
+    const uint32_t* table = &symmetries.table[0];
+
+    for (int s = 0; s < symmetries.count; s++, table += 4 * 256)
+    {
+        uint32_t x = table[xMask & 255] | table[256 + ((xMask >> 8) & 255)];
+        uint32_t o = table[oMask & 255] | table[256 + ((oMask >> 8) & 255)];
+        uint32_t code = packState(x, o, toMove);
+        if (code < best)
+            best = code;
+    }
+    return best;
+}
+
+// For std::unordered_set / unordered_map: spreads codes, which are dense in
+// their low bits, over the whole word
+struct PackedStateHash
+{
+    size_t operator()(uint32_t code) const
+    {
+        return (size_t)((code * 0x9e3779b97f4a7c15ULL) >> 16);
+    }
+};
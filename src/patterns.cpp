@@ -0,0 +1,57 @@
+#include "patterns.h"
+
+#include <cstdio>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static const char* PATTERN_FILE_HEADER = "tictactoe-patterns";
+static const int PATTERN_FILE_VERSION = 1;
+
+bool loadPatternWeights(const std::string& path, PatternWeights& patterns)
+{
+    std::ifstream file(path);
+    std::string header;
+    int version = 0;
+    if (!(file >> header >> version) || header != PATTERN_FILE_HEADER || version != PATTERN_FILE_VERSION)
+        return false;
+
+    PatternWeights loaded;
+    for (int i = 0; i < PATTERN_TABLE_SIZE; i++)
+    {
+        if (!(file >> loaded.weights[i]))
+            return false;
+    }
+    patterns = loaded;
+    return true;
+}
+
+bool savePatternWeights(const std::string& path, const PatternWeights& patterns)
+{
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary);
+        file << PATTERN_FILE_HEADER << " " << PATTERN_FILE_VERSION << "\n";
+        char text[32];
+        for (int own = 0; own < PATTERN_SIDE; own++)
+        {
+            for (int other = 0; other < PATTERN_SIDE; other++)
+            {
+                snprintf(text, sizeof(text), "%s%.9g", other ? " " : "", patterns.weights[own * PATTERN_SIDE + other]);
+                file << text;
+            }
+            file << "\n";
+        }
+        if (!file.flush())
+            return false;
+    }
+
+    // Both replace `path` in one step, so readers see the old or the new file
+#ifdef _WIN32
+    return MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+}
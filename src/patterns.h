@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include "hypergraph.h"
+
+// Learned evaluation over line patterns. A line's pattern is how many stones
+// the side to move and the opponent have on it, each capped at
+// PATTERN_MAX_COUNT, and every pattern has one weight. The position's score
+// is the mean weight over all lines, so the same weights suit any board
+// size. The built-in evaluation in HypergraphRules is the hand-set special
+// case that only scores lines one side has to itself.
+//
+// Weights are trained by `tictactoe-cli train` (see trainer.h) and loaded
+// by the engine with "weights FILE" or by tournament players with
+// "name:weights=FILE".
+const int PATTERN_MAX_COUNT = 7;
+const int PATTERN_SIDE = PATTERN_MAX_COUNT + 1;
+const int PATTERN_TABLE_SIZE = PATTERN_SIDE * PATTERN_SIDE;
+
+// Engine score (centipawn-like) for a mean weight of 1.0, and the bound that
+// keeps pattern scores clear of the search's forced-win scores
+const int PATTERN_SCORE_SCALE = 1000;
+const int PATTERN_SCORE_LIMIT = 20000;
+
+struct PatternWeights
+{
+    float weights[PATTERN_TABLE_SIZE] = {};
+};
+
+inline int patternIndex(int own, int other)
+{
+    return (own < PATTERN_MAX_COUNT ? own : PATTERN_MAX_COUNT) * PATTERN_SIDE
+        + (other < PATTERN_MAX_COUNT ? other : PATTERN_MAX_COUNT);
+}
+
+// Mean weight over the lines, for `player` to move
+inline float patternValue(const float* weights, const LineState& lines, const Hypergraph& graph, int player)
+{
+    float sum = 0.0f;
+    for (int line = 0; line < graph.lineCount; line++)
+        sum += weights[patternIndex(lines.counts[player][line], lines.counts[1 - player][line])];
+    return graph.lineCount > 0 ? sum / graph.lineCount : 0.0f;
+}
+
+inline int patternScore(const PatternWeights& patterns, const LineState& lines, const Hypergraph& graph, int player)
+{
+    float score = patternValue(patterns.weights, lines, graph, player) * PATTERN_SCORE_SCALE;
+    if (score > PATTERN_SCORE_LIMIT)
+        return PATTERN_SCORE_LIMIT;
+    if (score < -PATTERN_SCORE_LIMIT)
+        return -PATTERN_SCORE_LIMIT;
+    return (int)score;
+}
+
+// Text file: a "tictactoe-patterns 1" header line, then PATTERN_SIDE rows of
+// PATTERN_SIDE weights (row = own stones, column = opponent stones).
+// Returns false if the file cannot be read or is malformed.
+bool loadPatternWeights(const std::string& path, PatternWeights& patterns);
+
+// Writes to a temporary file and renames it over `path`, so a reader never
+// sees a half-written snapshot. Returns false on I/O errors.
+bool savePatternWeights(const std::string& path, const PatternWeights& patterns);
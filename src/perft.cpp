@@ -0,0 +1,46 @@
+#include "perft.h"
+
+#include <chrono>
+#include <iostream>
+#include "options.h"
+
+int runPerftCommand(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, 2, options))
+        return 1;
+
+    // The reference counts assume games only end on a win or a full board
+    Hypergraph graph;
+    if (!makeGameFromOptions(options, graph))
+        return 1;
+    HypergraphRules rules(graph, hasOption(options, "early-draws"));
+    HypergraphState state;
+    rules.reset(state);
+    if (!applyMoveList(rules, state, getOption(options, "moves", "")))
+        return 1;
+
+    long long depth = getIntOption(options, "depth", rules.graph.cellCount - state.moveCount);
+    if (depth < 0 || depth > rules.graph.cellCount)
+    {
+        std::cout << "Expected --depth from 0 to " << rules.graph.cellCount << std::endl;
+        return 1;
+    }
+    TaskPool& pool = taskPoolFromOptions(options);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<PerftDivide> divide;
+    uint64_t nodes = perftParallel(rules, state, (int)depth, pool, divide);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (hasOption(options, "divide"))
+    {
+        for (size_t i = 0; i < divide.size(); i++)
+            std::cout << divide[i].move << ": " << divide[i].nodes << std::endl;
+    }
+
+    std::cout << "perft " << depth << ": " << nodes << " nodes" << std::endl;
+    std::cout << "time: " << (long long)(seconds * 1000) << " ms, threads: " << pool.describe() << std::endl;
+    std::cout << "nps: " << (long long)(seconds > 0 ? nodes / seconds : 0) << std::endl;
+    return 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "rules.h"
+#include "task_pool.h"
+
+// Counts the leaves of the game tree below `state` to `depth` plies. Games
+// that end earlier count as one leaf, so on 3x3 with early draws disabled
+// perft(9) from the start is the number of complete games, 255168.
+//
+// `moves` needs room for (depth * rules.maxMoves()) entries.
+template<class Rules>
+uint64_t perft(const Rules& rules, typename Rules::State& state, int depth, int* moves)
+{
+    if (depth <= 0 || rules.isTerminal(state))
+        return 1;
+
+    int count = rules.generateMoves(state, moves);
+
+    // Bulk counting: every child of a last-ply node is a leaf
+    if (depth == 1)
+        return count;
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < count; i++)
+    {
+        rules.makeMove(state, moves[i]);
+        nodes += perft(rules, state, depth - 1, moves + count);
+        rules.unmakeMove(state, moves[i]);
+    }
+    return nodes;
+}
+
+struct PerftDivide
+{
+    int move;
+    uint64_t nodes;
+};
+
+// Subtrees at least this deep are split once more across the pool
+const int PERFT_SPLIT_DEPTH = 5;
+
+// perft below a root move, with the children of a deep subtree counted as
+// separate tasks so idle workers can steal part of a big root move
+template<class Rules>
+uint64_t perftSplit(const Rules& rules, const typename Rules::State& state, int depth, TaskPool& pool)
+{
+    std::vector<int> moves((size_t)depth * rules.maxMoves() + 1);
+    typename Rules::State copy = state;
+    if (depth < PERFT_SPLIT_DEPTH || rules.isTerminal(copy))
+        return perft(rules, copy, depth, &moves[0]);
+
+    int count = rules.generateMoves(copy, &moves[0]);
+    std::vector<uint64_t> counts(count);
+    parallelFor(pool, 0, count, 1, [&](uint64_t i)
+    {
+        typename Rules::State child = state;
+        std::vector<int> childMoves((size_t)depth * rules.maxMoves() + 1);
+        rules.makeMove(child, moves[i]);
+        counts[i] = perft(rules, child, depth - 1, &childMoves[0]);
+    });
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < count; i++)
+        nodes += counts[i];
+    return nodes;
+}
+
+// Splits the tree at the root (and deep root moves again, see perftSplit)
+// into tasks on `pool`, each working on its own copy of the state
+template<class Rules>
+uint64_t perftParallel(const Rules& rules, const typename Rules::State& state, int depth, TaskPool& pool, std::vector<PerftDivide>& divide)
+{
+    divide.clear();
+    if (depth <= 1 || rules.isTerminal(state))
+    {
+        typename Rules::State copy = state;
+        std::vector<int> moves((size_t)rules.maxMoves() + 1);
+        return perft(rules, copy, depth, &moves[0]);
+    }
+
+    std::vector<int> rootMoves(rules.maxMoves());
+    int rootCount = rules.generateMoves(state, &rootMoves[0]);
+    for (int i = 0; i < rootCount; i++)
+    {
+        PerftDivide entry = {rootMoves[i], 0};
+        divide.push_back(entry);
+    }
+
+    parallelFor(pool, 0, rootCount, 1, [&](uint64_t i)
+    {
+        typename Rules::State copy = state;
+        rules.makeMove(copy, divide[i].move);
+        divide[i].nodes = perftSplit(rules, copy, depth - 1, pool);
+    });
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < rootCount; i++)
+        nodes += divide[i].nodes;
+    return nodes;
+}
+
+// `tictactoe-cli perft ...`
+int runPerftCommand(int argc, char** argv);
@@ -0,0 +1,208 @@
+#include "playout.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include "options.h"
+#include "random.h"
+#include "simd_kernels.h"
+
+// Largest batch any kernel plays at once (AVX-512)
+const int MAX_LANES = 32;
+
+PlayoutBoard makePlayoutBoard(const Hypergraph& graph)
+{
+    PlayoutBoard board;
+    board.cellCount = graph.cellCount;
+    if (graph.cellCount > 64)
+        return board;
+
+    for (int line = 0; line < graph.lineCount; line++)
+    {
+        uint64_t mask = 0;
+        for (int i = graph.lineStart[line]; i < graph.lineStart[line + 1]; i++)
+            mask |= 1ULL << graph.lineCells[i];
+        board.winMasks.push_back(mask);
+    }
+    return board;
+}
+
+const char* playoutKernelName(const PlayoutBoard& board)
+{
+    return board.cellCount <= 16 ? simdLevelName(simdKernels().level) : "scalar-wide";
+}
+
+static int startOutcome(const PlayoutBoard& board, uint64_t xMask, uint64_t oMask)
+{
+    for (size_t line = 0; line < board.winMasks.size(); line++)
+    {
+        if ((xMask & board.winMasks[line]) == board.winMasks[line])
+            return PLAYOUT_X_WINS;
+        if ((oMask & board.winMasks[line]) == board.winMasks[line])
+            return PLAYOUT_O_WINS;
+    }
+    return -1;
+}
+
+static void countOutcome(PlayoutResults& results, int outcome)
+{
+    if (outcome == PLAYOUT_X_WINS)
+        results.xWins++;
+    else if (outcome == PLAYOUT_O_WINS)
+        results.oWins++;
+    else
+        results.draws++;
+}
+
+// One game at a time on 64-bit masks, for boards too big for 16-bit lanes
+static int playoutWide(const PlayoutBoard& board, uint64_t xMask, uint64_t oMask, int toMove, Xoshiro128& rng)
+{
+    uint64_t full = board.cellCount == 64 ? ~0ULL : (1ULL << board.cellCount) - 1;
+    uint64_t stones[2] = {xMask, oMask};
+    int side = toMove;
+
+    for (int empties = board.cellCount - __builtin_popcountll(xMask | oMask); empties > 0; empties--)
+    {
+        int r = randomBelow(rng, empties);
+
+        uint64_t empty = full & ~(stones[0] | stones[1]);
+        while (r-- > 0)
+            empty &= empty - 1;
+        stones[side] |= empty & (~empty + 1);
+
+        for (size_t line = 0; line < board.winMasks.size(); line++)
+        {
+            if ((stones[side] & board.winMasks[line]) == board.winMasks[line])
+                return side == 0 ? PLAYOUT_X_WINS : PLAYOUT_O_WINS;
+        }
+        side ^= 1;
+    }
+    return PLAYOUT_DRAW;
+}
+
+PlayoutResults playRandomGames(const PlayoutBoard& board, uint64_t xMask, uint64_t oMask, int toMove,
+    uint64_t games, uint64_t seed, uint8_t* outcomes)
+{
+    PlayoutResults results;
+
+    int start = startOutcome(board, xMask, oMask);
+    if (start != -1)
+    {
+        for (uint64_t g = 0; g < games; g++)
+        {
+            countOutcome(results, start);
+            if (outcomes)
+                outcomes[g] = (uint8_t)start;
+        }
+        return results;
+    }
+
+    if (board.cellCount > 16)
+    {
+        for (uint64_t g = 0; g < games; g++)
+        {
+            Xoshiro128 rng;
+            seedRandom(rng, seed, g);
+            int outcome = playoutWide(board, xMask, oMask, toMove, rng);
+            countOutcome(results, outcome);
+            if (outcomes)
+                outcomes[g] = (uint8_t)outcome;
+        }
+        return results;
+    }
+
+    uint16_t winMasks[64];
+    int lineCount = 0;
+    for (size_t line = 0; line < board.winMasks.size() && lineCount < 64; line++)
+        winMasks[lineCount++] = (uint16_t)board.winMasks[line];
+
+    const SimdKernels& kernels = simdKernels();
+    const int lanes = kernels.playoutLanes;
+    uint16_t random[16 * MAX_LANES];
+    uint16_t winners[MAX_LANES];
+    RandomBatch rng;
+
+    // Game g always draws from stream g, whatever the lane count
+    for (uint64_t first = 0; first < games; first += lanes)
+    {
+        if (lanes == 1)
+        {
+            // The scalar kernel: one plain generator, no batch to set up
+            Xoshiro128 single;
+            seedRandom(single, seed, first);
+            for (int step = 0; step < board.cellCount; step++)
+                random[step] = (uint16_t)(nextRandom(single) >> 16);
+        }
+        else
+        {
+            // Kernels wider than a generator batch take several side by side
+            for (int group = 0; group < lanes; group += RANDOM_BATCH_LANES)
+            {
+                seedRandomBatch(rng, seed, first + group, std::min(lanes - group, RANDOM_BATCH_LANES));
+                fillRandom16(rng, random + group, board.cellCount, lanes);
+            }
+        }
+        kernels.playout(board.cellCount, winMasks, lineCount, (uint16_t)xMask, (uint16_t)oMask,
+            toMove, random, winners);
+
+        for (int lane = 0; lane < lanes && first + lane < games; lane++)
+        {
+            countOutcome(results, winners[lane]);
+            if (outcomes)
+                outcomes[first + lane] = (uint8_t)winners[lane];
+        }
+    }
+    return results;
+}
+
+int runPlayoutCommand(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, 2, options))
+        return 1;
+
+    Hypergraph graph;
+    if (!makeGameFromOptions(options, graph))
+        return 1;
+    HypergraphRules rules(graph, false);
+    HypergraphState state;
+    rules.reset(state);
+    if (!applyMoveList(rules, state, getOption(options, "moves", "")))
+        return 1;
+
+    PlayoutBoard board = makePlayoutBoard(rules.graph);
+    if (board.winMasks.empty())
+    {
+        std::cout << "playout supports boards of at most 64 cells" << std::endl;
+        return 1;
+    }
+
+    uint64_t masks[2] = {0, 0};
+    for (int cell = 0; cell < rules.graph.cellCount; cell++)
+    {
+        if (state.cells[cell] != EMPTY_CELL)
+            masks[state.cells[cell]] |= 1ULL << cell;
+    }
+
+    // Read signed: a negative count would wrap to an endless run
+    long long gameCount = getIntOption(options, "games", 1000000);
+    if (gameCount < 1)
+    {
+        std::cout << "Expected --games >= 1" << std::endl;
+        return 1;
+    }
+    uint64_t games = (uint64_t)gameCount;
+    uint64_t seed = (uint64_t)getIntOption(options, "seed", 1);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    PlayoutResults results = playRandomGames(board, masks[0], masks[1], state.toMove, games, seed);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "games: " << games << " (kernel: " << playoutKernelName(board) << ")" << std::endl;
+    std::cout << "x wins: " << 100.0 * results.xWins / games << "%, o wins: " << 100.0 * results.oWins / games
+        << "%, draws: " << 100.0 * results.draws / games << "%" << std::endl;
+    std::cout << "time: " << (long long)(seconds * 1000) << " ms, games/s: " << (long long)(seconds > 0 ? games / seconds : 0) << std::endl;
+    return 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "hypergraph.h"
+
+// Bitboard form of a board for random playouts: one bit per cell and one
+// mask per winning line. Boards up to 16 cells (3x3, 4x4) run in the SIMD
+// kernels with one game per 16-bit lane; larger boards up to 64 cells fall
+// back to a scalar loop.
+struct PlayoutBoard
+{
+    int cellCount = 0;
+    std::vector<uint64_t> winMasks;
+};
+
+PlayoutBoard makePlayoutBoard(const Hypergraph& graph);
+
+enum PlayoutOutcome
+{
+    PLAYOUT_DRAW = 0,
+    PLAYOUT_X_WINS = 1,
+    PLAYOUT_O_WINS = 2
+};
+
+struct PlayoutResults
+{
+    uint64_t xWins = 0;
+    uint64_t oWins = 0;
+    uint64_t draws = 0;
+};
+
+// Plays `games` uniformly random games to completion from the position given
+// by the two stone masks and the side to move. Game i draws its moves from
+// random stream (seed, i), so outcomes are reproducible per game and do not
+// depend on the kernel. If `outcomes` is not null it receives one
+// PlayoutOutcome per game.
+PlayoutResults playRandomGames(const PlayoutBoard& board, uint64_t xMask, uint64_t oMask, int toMove,
+    uint64_t games, uint64_t seed, uint8_t* outcomes = nullptr);
+
+// Name of the kernel playRandomGames uses for this board ("avx2", ...)
+const char* playoutKernelName(const PlayoutBoard& board);
+
+// `tictactoe-cli playout ...`
+int runPlayoutCommand(int argc, char** argv);
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Random playouts for boards of at most 16 cells, one game per 16-bit lane.
+// The kernel is written once against a small set of lane operations and
+// instantiated for plain integers, SSE2, AVX2 and AVX-512, each in the
+// translation unit built for that instruction set (see simd_kernels.h), hence
+// the internal linkage. Every lane runs the same instruction stream: finished
+// games are masked out instead of branched on.
+
+namespace {
+
+struct ScalarLanes
+{
+    typedef uint16_t Reg;
+    static const int LANES = 1;
+
+    static Reg zero() { return 0; }
+    static Reg set1(uint16_t value) { return value; }
+    static Reg load(const uint16_t* p) { return *p; }
+    static void store(uint16_t* p, Reg a) { *p = a; }
+    static Reg bitAnd(Reg a, Reg b) { return a & b; }
+    static Reg bitOr(Reg a, Reg b) { return a | b; }
+    static Reg andNot(Reg a, Reg b) { return a & (uint16_t)~b; }
+    static Reg cmpEq(Reg a, Reg b) { return a == b ? 0xFFFF : 0; }
+    static Reg add(Reg a, Reg b) { return (uint16_t)(a + b); }
+    static Reg mulHi(Reg a, Reg b) { return (uint16_t)(((uint32_t)a * b) >> 16); }
+    static bool allZero(Reg a) { return a == 0; }
+};
+
+#if defined(__SSE2__)
+struct Sse2Lanes
+{
+    typedef __m128i Reg;
+    static const int LANES = 8;
+
+    static Reg zero() { return _mm_setzero_si128(); }
+    static Reg set1(uint16_t value) { return _mm_set1_epi16((short)value); }
+    static Reg load(const uint16_t* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static void store(uint16_t* p, Reg a) { _mm_storeu_si128((__m128i*)p, a); }
+    static Reg bitAnd(Reg a, Reg b) { return _mm_and_si128(a, b); }
+    static Reg bitOr(Reg a, Reg b) { return _mm_or_si128(a, b); }
+    static Reg andNot(Reg a, Reg b) { return _mm_andnot_si128(b, a); }
+    static Reg cmpEq(Reg a, Reg b) { return _mm_cmpeq_epi16(a, b); }
+    static Reg add(Reg a, Reg b) { return _mm_add_epi16(a, b); }
+    static Reg mulHi(Reg a, Reg b) { return _mm_mulhi_epu16(a, b); }
+    static bool allZero(Reg a) { return _mm_movemask_epi8(_mm_cmpeq_epi16(a, _mm_setzero_si128())) == 0xFFFF; }
+};
+#endif
+
+#if defined(__AVX2__)
+struct Avx2Lanes
+{
+    typedef __m256i Reg;
+    static const int LANES = 16;
+
+    static Reg zero() { return _mm256_setzero_si256(); }
+    static Reg set1(uint16_t value) { return _mm256_set1_epi16((short)value); }
+    static Reg load(const uint16_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static void store(uint16_t* p, Reg a) { _mm256_storeu_si256((__m256i*)p, a); }
+    static Reg bitAnd(Reg a, Reg b) { return _mm256_and_si256(a, b); }
+    static Reg bitOr(Reg a, Reg b) { return _mm256_or_si256(a, b); }
+    static Reg andNot(Reg a, Reg b) { return _mm256_andnot_si256(b, a); }
+    static Reg cmpEq(Reg a, Reg b) { return _mm256_cmpeq_epi16(a, b); }
+    static Reg add(Reg a, Reg b) { return _mm256_add_epi16(a, b); }
+    static Reg mulHi(Reg a, Reg b) { return _mm256_mulhi_epu16(a, b); }
+    static bool allZero(Reg a) { return _mm256_testz_si256(a, a) != 0; }
+};
+#endif
+
+#if defined(__AVX512BW__)
+struct Avx512Lanes
+{
+    typedef __m512i Reg;
+    static const int LANES = 32;
+
+    static Reg zero() { return _mm512_setzero_si512(); }
+    static Reg set1(uint16_t value) { return _mm512_set1_epi16((short)value); }
+    static Reg load(const uint16_t* p) { return _mm512_loadu_si512(p); }
+    static void store(uint16_t* p, Reg a) { _mm512_storeu_si512(p, a); }
+    static Reg bitAnd(Reg a, Reg b) { return _mm512_and_si512(a, b); }
+    static Reg bitOr(Reg a, Reg b) { return _mm512_or_si512(a, b); }
+    static Reg andNot(Reg a, Reg b) { return _mm512_andnot_si512(b, a); }
+    static Reg cmpEq(Reg a, Reg b) { return _mm512_movm_epi16(_mm512_cmpeq_epi16_mask(a, b)); }
+    static Reg add(Reg a, Reg b) { return _mm512_add_epi16(a, b); }
+    static Reg mulHi(Reg a, Reg b) { return _mm512_mulhi_epu16(a, b); }
+    static bool allZero(Reg a) { return _mm512_test_epi16_mask(a, a) == 0; }
+};
+#endif
+
+// Plays V::LANES games from the same start position. `random` holds
+// V::LANES values per move; `winners` receives 0 (draw), 1 (X) or 2 (O)
+// per lane.
+template<class V>
+void playoutLanes(int cellCount, const uint16_t* winMasks, int lineCount, uint16_t xMask, uint16_t oMask,
+    int toMove, const uint16_t* random, uint16_t* winners)
+{
+    typedef typename V::Reg Reg;
+
+    const Reg zero = V::zero();
+    const Reg full = V::set1((uint16_t)((1u << cellCount) - 1));
+    Reg stones[2] = {V::set1(xMask), V::set1(oMask)};
+    Reg active = V::set1(0xFFFF);
+    Reg winner = zero;
+
+    int side = toMove;
+    int empties = cellCount - __builtin_popcount(xMask | oMask);
+
+    for (int step = 0; empties > 0; step++, empties--)
+    {
+        // Pick the r-th empty cell with r uniform in [0, empties)
+        Reg empty = V::andNot(full, V::bitOr(stones[0], stones[1]));
+        Reg r = V::mulHi(V::load(random + step * V::LANES), V::set1((uint16_t)empties));
+        Reg chosen = zero;
+
+        for (int cell = 0; cell < cellCount; cell++)
+        {
+            Reg bit = V::set1((uint16_t)(1u << cell));
+            Reg isEmpty = V::cmpEq(V::bitAnd(empty, bit), bit);
+            Reg hit = V::bitAnd(isEmpty, V::cmpEq(r, zero));
+            chosen = V::bitOr(chosen, V::bitAnd(hit, bit));
+            // isEmpty is all ones, so this counts r down past each empty cell
+            r = V::add(r, isEmpty);
+        }
+
+        stones[side] = V::bitOr(stones[side], V::bitAnd(chosen, active));
+
+        Reg won = zero;
+        for (int line = 0; line < lineCount; line++)
+        {
+            Reg mask = V::set1(winMasks[line]);
+            won = V::bitOr(won, V::cmpEq(V::bitAnd(stones[side], mask), mask));
+        }
+        won = V::bitAnd(won, active);
+        winner = V::bitOr(winner, V::bitAnd(won, V::set1(side == 0 ? 1 : 2)));
+        active = V::andNot(active, won);
+
+        if (V::allZero(active))
+            break;
+        side ^= 1;
+    }
+
+    V::store(winners, winner);
+}
+
+}
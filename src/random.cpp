@@ -0,0 +1,69 @@
+#include "random.h"
+
+#include "simd_kernels.h"
+
+static uint64_t splitMix(uint64_t& x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void seedRandom(Xoshiro128& rng, uint64_t seed, uint64_t stream)
+{
+    uint64_t x = seed ^ (stream * 0xd1342543de82ef95ULL);
+    uint64_t a = splitMix(x);
+    uint64_t b = splitMix(x);
+    rng.s[0] = (uint32_t)a;
+    rng.s[1] = (uint32_t)(a >> 32);
+    rng.s[2] = (uint32_t)b;
+    rng.s[3] = (uint32_t)(b >> 32);
+
+    // The all-zero state is the one state xoshiro cannot leave
+    if ((rng.s[0] | rng.s[1] | rng.s[2] | rng.s[3]) == 0)
+        rng.s[0] = 1;
+}
+
+void seedRandomBatch(RandomBatch& batch, uint64_t seed, uint64_t firstStream, int lanes)
+{
+    batch.lanes = lanes;
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        Xoshiro128 rng;
+        seedRandom(rng, seed, firstStream + lane);
+        for (int w = 0; w < 4; w++)
+            batch.s[w][lane] = rng.s[w];
+    }
+
+    // Vector steps may round up into the unused lanes; all-zero lanes stay zero
+    for (int lane = lanes; lane < RANDOM_BATCH_LANES; lane++)
+    {
+        for (int w = 0; w < 4; w++)
+            batch.s[w][lane] = 0;
+    }
+}
+
+void fillRandom16(RandomBatch& batch, uint16_t* out, int steps, int stride)
+{
+    void (*step)(RandomBatch&, uint32_t*) = simdKernels().randomStep;
+    uint32_t values[RANDOM_BATCH_LANES];
+    for (int i = 0; i < steps; i++, out += stride)
+    {
+        step(batch, values);
+        for (int lane = 0; lane < batch.lanes; lane++)
+            out[lane] = (uint16_t)(values[lane] >> 16);
+    }
+}
+
+void fillRandomCells(RandomBatch& batch, uint8_t* out, int steps, int cellCount)
+{
+    void (*step)(RandomBatch&, uint32_t*) = simdKernels().randomStep;
+    uint32_t values[RANDOM_BATCH_LANES];
+    for (int i = 0; i < steps; i++, out += batch.lanes)
+    {
+        step(batch, values);
+        for (int lane = 0; lane < batch.lanes; lane++)
+            out[lane] = (uint8_t)(((values[lane] >> 16) * (uint32_t)cellCount) >> 16);
+    }
+}
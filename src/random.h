@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+// xoshiro128++ random numbers. Every game gets its own stream, derived from
+// (seed, stream index), so a run is reproducible game by game no matter how
+// many games are batched together or which SIMD width plays them.
+
+struct Xoshiro128
+{
+    uint32_t s[4];
+};
+
+void seedRandom(Xoshiro128& rng, uint64_t seed, uint64_t stream);
+
+inline uint32_t nextRandom(Xoshiro128& rng)
+{
+    uint32_t* s = rng.s;
+    uint32_t sum = s[0] + s[3];
+    uint32_t result = ((sum << 7) | (sum >> 25)) + s[0];
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 11) | (s[3] >> 21);
+    return result;
+}
+
+// Uniform value in [0, range) for range <= 65536
+inline int randomBelow(Xoshiro128& rng, int range)
+{
+    return (int)(((nextRandom(rng) >> 16) * (uint32_t)range) >> 16);
+}
+
+// Up to RANDOM_BATCH_LANES generators in struct-of-arrays layout, advanced
+// together with SIMD. Lane i produces exactly the stream a scalar Xoshiro128
+// seeded with (seed, firstStream + i) would. Only the first `lanes` lanes are
+// seeded and stepped (rounded up to the vector width).
+const int RANDOM_BATCH_LANES = 16;
+
+struct RandomBatch
+{
+    alignas(32) uint32_t s[4][RANDOM_BATCH_LANES];
+    int lanes;
+};
+
+void seedRandomBatch(RandomBatch& batch, uint64_t seed, uint64_t firstStream, int lanes);
+
+// Fills out[step * stride + lane] with the high 16 bits of the next output of
+// each lane, for `steps` steps. A stride wider than the batch lets several
+// batches fill one buffer side by side.
+void fillRandom16(RandomBatch& batch, uint16_t* out, int steps, int stride);
+
+// Like fillRandom16 with stride = lanes, but each value is a cell index in
+// [0, cellCount)
+void fillRandomCells(RandomBatch& batch, uint8_t* out, int steps, int cellCount);
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include "random.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// One step of every generator in a RandomBatch, per instruction set. Only the
+// variants the including translation unit is compiled for are defined.
+// Everything here has internal linkage, so copies built for different
+// instruction sets can never be merged by the linker.
+namespace {
+
+inline void stepBatchScalar(RandomBatch& batch, uint32_t* out)
+{
+    for (int lane = 0; lane < batch.lanes; lane++)
+    {
+        Xoshiro128 rng;
+        for (int w = 0; w < 4; w++)
+            rng.s[w] = batch.s[w][lane];
+        out[lane] = nextRandom(rng);
+        for (int w = 0; w < 4; w++)
+            batch.s[w][lane] = rng.s[w];
+    }
+}
+
+#if defined(__SSE2__)
+inline void stepBatchSse2(RandomBatch& batch, uint32_t* out)
+{
+    for (int lane = 0; lane < batch.lanes; lane += 4)
+    {
+        __m128i s0 = _mm_load_si128((const __m128i*)&batch.s[0][lane]);
+        __m128i s1 = _mm_load_si128((const __m128i*)&batch.s[1][lane]);
+        __m128i s2 = _mm_load_si128((const __m128i*)&batch.s[2][lane]);
+        __m128i s3 = _mm_load_si128((const __m128i*)&batch.s[3][lane]);
+
+        __m128i sum = _mm_add_epi32(s0, s3);
+        __m128i result = _mm_add_epi32(_mm_or_si128(_mm_slli_epi32(sum, 7), _mm_srli_epi32(sum, 25)), s0);
+        __m128i t = _mm_slli_epi32(s1, 9);
+
+        s2 = _mm_xor_si128(s2, s0);
+        s3 = _mm_xor_si128(s3, s1);
+        s1 = _mm_xor_si128(s1, s2);
+        s0 = _mm_xor_si128(s0, s3);
+        s2 = _mm_xor_si128(s2, t);
+        s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+        _mm_store_si128((__m128i*)&batch.s[0][lane], s0);
+        _mm_store_si128((__m128i*)&batch.s[1][lane], s1);
+        _mm_store_si128((__m128i*)&batch.s[2][lane], s2);
+        _mm_store_si128((__m128i*)&batch.s[3][lane], s3);
+        _mm_storeu_si128((__m128i*)&out[lane], result);
+    }
+}
+#endif
+
+#if defined(__AVX2__)
+inline void stepBatchAvx2(RandomBatch& batch, uint32_t* out)
+{
+    for (int lane = 0; lane < batch.lanes; lane += 8)
+    {
+        __m256i s0 = _mm256_load_si256((const __m256i*)&batch.s[0][lane]);
+        __m256i s1 = _mm256_load_si256((const __m256i*)&batch.s[1][lane]);
+        __m256i s2 = _mm256_load_si256((const __m256i*)&batch.s[2][lane]);
+        __m256i s3 = _mm256_load_si256((const __m256i*)&batch.s[3][lane]);
+
+        __m256i sum = _mm256_add_epi32(s0, s3);
+        __m256i result = _mm256_add_epi32(_mm256_or_si256(_mm256_slli_epi32(sum, 7), _mm256_srli_epi32(sum, 25)), s0);
+        __m256i t = _mm256_slli_epi32(s1, 9);
+
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi32(s3, 11), _mm256_srli_epi32(s3, 21));
+
+        _mm256_store_si256((__m256i*)&batch.s[0][lane], s0);
+        _mm256_store_si256((__m256i*)&batch.s[1][lane], s1);
+        _mm256_store_si256((__m256i*)&batch.s[2][lane], s2);
+        _mm256_store_si256((__m256i*)&batch.s[3][lane], s3);
+        _mm256_storeu_si256((__m256i*)&out[lane], result);
+    }
+}
+#endif
+
+#if defined(__AVX512F__)
+// All sixteen lanes in one register, with native rotates
+inline void stepBatchAvx512(RandomBatch& batch, uint32_t* out)
+{
+    __m512i s0 = _mm512_loadu_si512(&batch.s[0][0]);
+    __m512i s1 = _mm512_loadu_si512(&batch.s[1][0]);
+    __m512i s2 = _mm512_loadu_si512(&batch.s[2][0]);
+    __m512i s3 = _mm512_loadu_si512(&batch.s[3][0]);
+
+    __m512i result = _mm512_add_epi32(_mm512_rol_epi32(_mm512_add_epi32(s0, s3), 7), s0);
+    __m512i t = _mm512_slli_epi32(s1, 9);
+
+    s2 = _mm512_xor_si512(s2, s0);
+    s3 = _mm512_xor_si512(s3, s1);
+    s1 = _mm512_xor_si512(s1, s2);
+    s0 = _mm512_xor_si512(s0, s3);
+    s2 = _mm512_xor_si512(s2, t);
+    s3 = _mm512_rol_epi32(s3, 11);
+
+    _mm512_storeu_si512(&batch.s[0][0], s0);
+    _mm512_storeu_si512(&batch.s[1][0], s1);
+    _mm512_storeu_si512(&batch.s[2][0], s2);
+    _mm512_storeu_si512(&batch.s[3][0], s3);
+    _mm512_storeu_si512(out, result);
+}
+#endif
+
+}
@@ -0,0 +1,69 @@
+#include "rules.h"
+
+// splitmix64, used to fill the Zobrist tables deterministically
+static uint64_t nextRandom(uint64_t& seed)
+{
+    uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+HypergraphRules::HypergraphRules(const Hypergraph& graph, bool earlyDraws)
+    : graph(graph), earlyDraws(earlyDraws)
+{
+    uint64_t seed = 0x5454544f45ULL;
+    for (int p = 0; p < 2; p++)
+    {
+        zobrist[p].resize(graph.cellCount);
+        for (int cell = 0; cell < graph.cellCount; cell++)
+            zobrist[p][cell] = nextRandom(seed);
+    }
+}
+
+bool HypergraphRules::setPosition(State& state, const int8_t* cells) const
+{
+    reset(state);
+
+    int stones[2] = {0, 0};
+    int winLine[2] = {-1, -1};
+    for (int cell = 0; cell < graph.cellCount; cell++)
+    {
+        int player = cells[cell];
+        if (player == EMPTY_CELL)
+            continue;
+        if (player != 0 && player != 1)
+            return false;
+
+        state.cells[cell] = (int8_t)player;
+        state.hash ^= zobrist[player][cell];
+        stones[player]++;
+        int line = lineStatePlace(state.lines, graph, cell, player);
+        if (line != -1 && winLine[player] == -1)
+            winLine[player] = line;
+    }
+
+    // X moves first, so X has as many stones as O or one more
+    if (stones[0] != stones[1] && stones[0] != stones[1] + 1)
+        return false;
+    if (winLine[0] != -1 && winLine[1] != -1)
+        return false;
+
+    state.moveCount = stones[0] + stones[1];
+    state.toMove = stones[0] == stones[1] ? 0 : 1;
+    if (winLine[0] != -1 || winLine[1] != -1)
+    {
+        // The winner made the last move
+        int winner = winLine[0] != -1 ? 0 : 1;
+        if (state.toMove != 1 - winner)
+            return false;
+        state.status = winner == 0 ? GAME_X_WINS : GAME_O_WINS;
+        state.winLine = winLine[winner];
+        return true;
+    }
+
+    int emptyCells = graph.cellCount - state.moveCount;
+    if (emptyCells == 0 || (earlyDraws && lineStateIsDrawn(state.lines, graph, state.toMove, emptyCells)))
+        state.status = GAME_DRAW;
+    return true;
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "hypergraph.h"
+#include "patterns.h"
+
+// Game rules are passed to the search code as a compile-time policy type, so
+// every engine is instantiated (and inlined) per rule set. A policy provides:
+//
+//   typedef ... State;
+//   typedef ... TableMove;                           // integer type that holds any
+//                                                    // move, for the search's table
+//   int  maxMoves() const;                           // upper bound on legal moves
+//   int  maxPlies(const State&) const;               // upper bound on moves left
+//                                                    // in the game
+//   void reset(State& state) const;                  // start position
+//   int  generateMoves(const State&, int* moves) const;
+//   void makeMove(State&, int move) const;
+//   void unmakeMove(State&, int move) const;         // exact inverse of makeMove
+//   bool isTerminal(const State&) const;
+//   int  status(const State&) const;                 // GameStatus
+//   int  toMove(const State&) const;                 // 0 = X, 1 = O
+//   uint64_t hash(const State&) const;
+//   int  evaluate(const State&) const;               // heuristic, side to move,
+//                                                    // inside +-SCORE_WIN_BOUND
+//
+// Moves are ints (cell indices here, packed coordinates for InfiniteRules in
+// infinite_board.h). unmakeMove is only ever called for the last move
+// made, and makeMove only on positions that are not terminal.
+
+// Scores are from the point of view of the side to move. A win found at ply
+// p scores SCORE_WIN - p so shorter wins are preferred; evaluate() stays
+// strictly inside +-SCORE_WIN_BOUND so a heuristic is never taken for one.
+const int SCORE_WIN = 30000;
+const int SCORE_INFINITE = 32000;
+const int SCORE_WIN_BOUND = SCORE_WIN - 1000;
+
+enum GameStatus
+{
+    GAME_ONGOING = 0,
+    GAME_X_WINS,
+    GAME_O_WINS,
+    GAME_DRAW
+};
+
+const int8_t EMPTY_CELL = -1;
+
+struct HypergraphState
+{
+    std::vector<int8_t> cells;   // EMPTY_CELL, 0 (X) or 1 (O)
+    LineState lines;
+    int toMove = 0;
+    int moveCount = 0;
+    int status = GAME_ONGOING;
+    int winLine = -1;
+    uint64_t hash = 0;
+};
+
+// Rules for any game described by a Hypergraph. The 3x3 board in the window
+// is the instance makeGridGame(3, 3, 3).
+struct HypergraphRules
+{
+    typedef HypergraphState State;
+    typedef int16_t TableMove;   // boards have at most 32767 cells
+
+    Hypergraph graph;
+    bool earlyDraws;             // end the game once neither player can win
+    std::vector<uint64_t> zobrist[2];
+    std::shared_ptr<const PatternWeights> patterns;   // learned evaluation, if loaded
+
+    explicit HypergraphRules(const Hypergraph& graph, bool earlyDraws = true);
+
+    // Sets up the position given as one entry per cell (EMPTY_CELL, 0 or 1),
+    // with X to move when both sides have as many stones. Returns false if
+    // the stone counts or completed lines could not arise in a real game.
+    bool setPosition(State& state, const int8_t* cells) const;
+
+    int maxMoves() const
+    {
+        return graph.cellCount;
+    }
+
+    int maxPlies(const State& state) const
+    {
+        return graph.cellCount - state.moveCount;
+    }
+
+    void reset(State& state) const
+    {
+        state.cells.assign(graph.cellCount, EMPTY_CELL);
+        lineStateReset(state.lines, graph);
+        state.toMove = 0;
+        state.moveCount = 0;
+        state.status = GAME_ONGOING;
+        state.winLine = -1;
+        state.hash = 0;
+    }
+
+    int generateMoves(const State& state, int* moves) const
+    {
+        int count = 0;
+        for (int cell = 0; cell < graph.cellCount; cell++)
+        {
+            if (state.cells[cell] == EMPTY_CELL)
+                moves[count++] = cell;
+        }
+        return count;
+    }
+
+    void makeMove(State& state, int move) const
+    {
+        int player = state.toMove;
+        state.cells[move] = (int8_t)player;
+        state.hash ^= zobrist[player][move];
+        state.moveCount++;
+        state.toMove = 1 - player;
+
+        int line = lineStatePlace(state.lines, graph, move, player);
+        if (line != -1)
+        {
+            state.status = (player == 0) ? GAME_X_WINS : GAME_O_WINS;
+            state.winLine = line;
+        }
+        else
+        {
+            int emptyCells = graph.cellCount - state.moveCount;
+            if (emptyCells == 0 || (earlyDraws && lineStateIsDrawn(state.lines, graph, state.toMove, emptyCells)))
+                state.status = GAME_DRAW;
+        }
+    }
+
+    void unmakeMove(State& state, int move) const
+    {
+        int player = state.cells[move];
+        lineStateRemove(state.lines, graph, move, player);
+        state.cells[move] = EMPTY_CELL;
+        state.hash ^= zobrist[player][move];
+        state.moveCount--;
+        state.toMove = player;
+        state.status = GAME_ONGOING;
+        state.winLine = -1;
+    }
+
+    bool isTerminal(const State& state) const
+    {
+        return state.status != GAME_ONGOING;
+    }
+
+    int status(const State& state) const
+    {
+        return state.status;
+    }
+
+    int toMove(const State& state) const
+    {
+        return state.toMove;
+    }
+
+    uint64_t hash(const State& state) const
+    {
+        return state.hash;
+    }
+
+    // Lines that are still live and already hold stones are worth more the
+    // closer they are to complete, unless learned pattern weights are loaded.
+    // Long lines on big boards add up fast, hence the clamp.
+    int evaluate(const State& state) const
+    {
+        if (patterns)
+            return patternScore(*patterns, state.lines, graph, state.toMove);
+
+        static const int lineWeight[8] = {0, 1, 4, 16, 64, 256, 1024, 4096};
+        int score = 0;
+
+        for (int line = 0; line < graph.lineCount; line++)
+        {
+            int own = state.lines.counts[state.toMove][line];
+            int other = state.lines.counts[1 - state.toMove][line];
+            if (other == 0 && own > 0)
+                score += lineWeight[own < 7 ? own : 7];
+            else if (own == 0 && other > 0)
+                score -= lineWeight[other < 7 ? other : 7];
+        }
+        if (score >= SCORE_WIN_BOUND)
+            return SCORE_WIN_BOUND - 1;
+        if (score <= -SCORE_WIN_BOUND)
+            return -(SCORE_WIN_BOUND - 1);
+        return score;
+    }
+};
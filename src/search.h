@@ -0,0 +1,403 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "rules.h"
+
+struct SearchResult
+{
+    int bestMove = -1;
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    std::vector<int> pv;
+};
+
+// One root move of a multi-PV search, with its own principal variation
+// (which starts with the move itself)
+struct MultiPvLine
+{
+    int move = -1;
+    int score = 0;
+    std::vector<int> pv;
+};
+
+// Lines are sorted best first
+struct MultiPvResult
+{
+    std::vector<MultiPvLine> lines;
+    int depth = 0;
+    uint64_t nodes = 0;
+};
+
+struct SearchLimits
+{
+    int maxDepth = 64;
+    uint64_t maxNodes = 0;       // 0 = unlimited
+    int64_t maxTimeMs = 0;       // 0 = unlimited
+    const std::atomic<bool>* stop = nullptr;   // set from another thread to abort
+
+    // Called after every completed iteration, on the searching thread
+    std::function<void(const SearchResult&)> onIteration;
+};
+
+enum TTBound
+{
+    TT_NONE = 0,
+    TT_EXACT,
+    TT_LOWER,
+    TT_UPPER
+};
+
+// `Move` is the rules' TableMove: int16 keeps an entry at 16 bytes
+template<class Move>
+struct TTEntry
+{
+    uint64_t key;
+    int16_t score;
+    Move move;
+    int16_t depth;
+    uint8_t bound;
+    uint8_t generation;
+};
+
+// Iterative-deepening alpha-beta over any rules policy (see rules.h). The
+// transposition table is kept between searches.
+template<class Rules>
+class AlphaBetaSearch
+{
+public:
+    typedef typename Rules::State State;
+    typedef TTEntry<typename Rules::TableMove> Entry;
+
+    AlphaBetaSearch(const Rules& rules, int ttSizeLog2 = 20)
+        : rules(rules), table((size_t)1 << ttSizeLog2), tableMask(((size_t)1 << ttSizeLog2) - 1)
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        Entry empty = {0, 0, -1, 0, TT_NONE, 0};
+        std::fill(table.begin(), table.end(), empty);
+    }
+
+    SearchResult search(State& state, const SearchLimits& limits)
+    {
+        SearchResult result;
+        int depthLimit = beginSearch(state, limits);
+        if (rules.isTerminal(state))
+            return result;
+
+        for (int depth = 1; depth <= depthLimit; depth++)
+        {
+            rootBestMove = -1;
+            int score = negamax(state, depth, 0, -SCORE_INFINITE, SCORE_INFINITE);
+            if (aborted)
+                break;
+
+            result.bestMove = rootBestMove;
+            result.score = score;
+            result.depth = depth;
+            result.nodes = nodes;
+            extractPv(state, depth, result.pv);
+            if (limits.onIteration)
+                limits.onIteration(result);
+
+            // A proven win or loss cannot change with more depth
+            if (score >= SCORE_WIN_BOUND || score <= -SCORE_WIN_BOUND)
+                break;
+        }
+
+        // Always hand back a legal move, even if the first iteration ran out
+        if (result.bestMove == -1)
+        {
+            rules.generateMoves(state, &moveBuffer[0]);
+            result.bestMove = moveBuffer[0];
+        }
+
+        result.nodes = nodes;
+        return result;
+    }
+
+    // Scores the best `lineCount` root moves exactly, in a single search per
+    // depth that shares the transposition table. Each root move is searched
+    // with the score of the current lineCount-th best line as its lower
+    // bound, so only moves that can still make the list are searched in
+    // full. `onIteration`, if set, gets the lines after every completed depth
+    // (limits.onIteration gets the best line).
+    MultiPvResult searchMultiPv(State& state, const SearchLimits& limits, int lineCount,
+        const std::function<void(const MultiPvResult&)>& onIteration = nullptr)
+    {
+        MultiPvResult result;
+        int depthLimit = beginSearch(state, limits);
+        if (rules.isTerminal(state) || lineCount < 1)
+            return result;
+        nodes++;
+
+        std::vector<int> rootMoves(rules.maxMoves());
+        rootMoves.resize(rules.generateMoves(state, &rootMoves[0]));
+        lineCount = std::min(lineCount, (int)rootMoves.size());
+
+        // Root moves in the order of the last iteration's scores
+        std::vector<std::pair<int, int> > ranked;
+        for (size_t i = 0; i < rootMoves.size(); i++)
+            ranked.push_back(std::make_pair(-SCORE_INFINITE, rootMoves[i]));
+
+        for (int depth = 1; depth <= depthLimit; depth++)
+        {
+            std::vector<std::pair<int, int> > scored;
+            std::vector<int> best;   // top lineCount scores, descending
+            for (size_t i = 0; i < ranked.size(); i++)
+            {
+                int move = ranked[i].second;
+                int alpha = (int)best.size() < lineCount ? -SCORE_INFINITE : best.back();
+
+                rules.makeMove(state, move);
+                int score = -negamax(state, depth - 1, 1, -SCORE_INFINITE, -alpha);
+                rules.unmakeMove(state, move);
+                if (aborted)
+                    break;
+
+                scored.push_back(std::make_pair(score, move));
+                if (score > alpha)
+                {
+                    best.insert(std::upper_bound(best.begin(), best.end(), score, std::greater<int>()), score);
+                    if ((int)best.size() > lineCount)
+                        best.pop_back();
+                }
+            }
+            if (aborted)
+                break;
+
+            // Stable so that equal scores keep last iteration's order
+            std::stable_sort(scored.begin(), scored.end(),
+                [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first > b.first; });
+            ranked = scored;
+
+            result.lines.clear();
+            for (int i = 0; i < lineCount; i++)
+            {
+                MultiPvLine line;
+                line.move = ranked[i].second;
+                line.score = ranked[i].first;
+                rules.makeMove(state, line.move);
+                extractPv(state, depth - 1, line.pv);
+                rules.unmakeMove(state, line.move);
+                line.pv.insert(line.pv.begin(), line.move);
+                result.lines.push_back(line);
+            }
+            result.depth = depth;
+            result.nodes = nodes;
+
+            if (onIteration)
+                onIteration(result);
+            if (limits.onIteration)
+            {
+                SearchResult best;
+                best.bestMove = result.lines[0].move;
+                best.score = result.lines[0].score;
+                best.depth = depth;
+                best.nodes = nodes;
+                best.pv = result.lines[0].pv;
+                limits.onIteration(best);
+            }
+
+            // Nothing left to learn once every reported line is decided
+            bool allProven = true;
+            for (int i = 0; i < lineCount; i++)
+            {
+                if (ranked[i].first > -SCORE_WIN_BOUND && ranked[i].first < SCORE_WIN_BOUND)
+                    allProven = false;
+            }
+            if (allProven)
+                break;
+        }
+
+        // Always hand back at least one legal move
+        if (result.lines.empty())
+        {
+            MultiPvLine line;
+            line.move = rootMoves[0];
+            line.pv.push_back(line.move);
+            result.lines.push_back(line);
+        }
+
+        result.nodes = nodes;
+        return result;
+    }
+
+private:
+    const Rules& rules;
+    std::vector<Entry> table;
+    size_t tableMask;
+    std::vector<int> moveBuffer;
+    uint64_t nodes = 0;
+    uint64_t nodeLimit = 0;
+    const std::atomic<bool>* stopFlag = nullptr;
+    std::chrono::steady_clock::time_point deadline;
+    bool aborted = false;
+    int rootBestMove = -1;
+    uint8_t generation = 0;
+
+    // Returns the deepest iteration to run: no search goes past the end of
+    // the game, so that also bounds the move buffer
+    int beginSearch(const State& state, const SearchLimits& limits)
+    {
+        nodes = 0;
+        nodeLimit = limits.maxNodes;
+        stopFlag = limits.stop;
+        deadline = limits.maxTimeMs > 0 ? std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.maxTimeMs)
+            : std::chrono::steady_clock::time_point::max();
+        aborted = false;
+        generation++;
+
+        int depthLimit = std::max(std::min(limits.maxDepth, rules.maxPlies(state)), 0);
+        // One slice of moves per ply of the deepest iteration
+        moveBuffer.resize((size_t)rules.maxMoves() * (depthLimit + 1));
+        return depthLimit;
+    }
+
+    int negamax(State& state, int depth, int ply, int alpha, int beta)
+    {
+        nodes++;
+
+        if (nodeLimit != 0 && nodes >= nodeLimit)
+        {
+            aborted = true;
+            return 0;
+        }
+
+        // The clock and the stop flag are only polled every 1024 nodes, leaves
+        // included, since most nodes of a shallow search are leaves
+        if ((nodes & 1023) == 0 && ((stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed))
+            || std::chrono::steady_clock::now() >= deadline))
+        {
+            aborted = true;
+            return 0;
+        }
+
+        if (rules.isTerminal(state))
+        {
+            if (rules.status(state) == GAME_DRAW)
+                return 0;
+            // The side that just moved has won
+            return -(SCORE_WIN - ply);
+        }
+
+        if (depth == 0)
+            return rules.evaluate(state);
+
+        uint64_t key = rules.hash(state);
+        Entry& entry = table[key & tableMask];
+        int ttMove = -1;
+        if (entry.key == key && entry.bound != TT_NONE)
+        {
+            ttMove = entry.move;
+            if (ply > 0 && entry.depth >= depth)
+            {
+                int score = scoreFromTable(entry.score, ply);
+                if (entry.bound == TT_EXACT
+                    || (entry.bound == TT_LOWER && score >= beta)
+                    || (entry.bound == TT_UPPER && score <= alpha))
+                    return score;
+            }
+        }
+
+        int* moves = &moveBuffer[(size_t)ply * rules.maxMoves()];
+        int moveCount = rules.generateMoves(state, moves);
+
+        // Try the move from the table first
+        for (int i = 0; i < moveCount; i++)
+        {
+            if (moves[i] == ttMove)
+            {
+                std::swap(moves[0], moves[i]);
+                break;
+            }
+        }
+
+        int originalAlpha = alpha;
+        int bestScore = -SCORE_INFINITE;
+        int bestMove = moves[0];
+
+        for (int i = 0; i < moveCount; i++)
+        {
+            rules.makeMove(state, moves[i]);
+            int score = -negamax(state, depth - 1, ply + 1, -beta, -alpha);
+            rules.unmakeMove(state, moves[i]);
+
+            if (aborted)
+                return 0;
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestMove = moves[i];
+                if (ply == 0)
+                    rootBestMove = bestMove;
+            }
+            if (score > alpha)
+                alpha = score;
+            if (alpha >= beta)
+                break;
+        }
+
+        // Keep deeper results from the current search over shallower ones
+        if (entry.key != key && entry.generation == generation && entry.depth > depth)
+            return bestScore;
+
+        entry.key = key;
+        entry.generation = generation;
+        entry.score = (int16_t)scoreToTable(bestScore, ply);
+        entry.move = (typename Rules::TableMove)bestMove;
+        entry.depth = (int16_t)depth;
+        if (bestScore <= originalAlpha)
+            entry.bound = TT_UPPER;
+        else if (bestScore >= beta)
+            entry.bound = TT_LOWER;
+        else
+            entry.bound = TT_EXACT;
+
+        return bestScore;
+    }
+
+    // Win scores are stored relative to the node, not the root
+    static int scoreToTable(int score, int ply)
+    {
+        if (score >= SCORE_WIN_BOUND)
+            return score + ply;
+        if (score <= -SCORE_WIN_BOUND)
+            return score - ply;
+        return score;
+    }
+
+    static int scoreFromTable(int score, int ply)
+    {
+        if (score >= SCORE_WIN_BOUND)
+            return score - ply;
+        if (score <= -SCORE_WIN_BOUND)
+            return score + ply;
+        return score;
+    }
+
+    void extractPv(State& state, int depth, std::vector<int>& pv)
+    {
+        pv.clear();
+        while ((int)pv.size() < depth && !rules.isTerminal(state))
+        {
+            uint64_t key = rules.hash(state);
+            const Entry& entry = table[key & tableMask];
+            if (entry.key != key || entry.bound == TT_NONE || entry.move < 0)
+                break;
+            pv.push_back(entry.move);
+            rules.makeMove(state, entry.move);
+        }
+        for (int i = (int)pv.size() - 1; i >= 0; i--)
+            rules.unmakeMove(state, pv[i]);
+    }
+};
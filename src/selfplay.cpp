@@ -0,0 +1,274 @@
+#include "selfplay.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Each worker fills a buffer this big before handing it to its shard in one
+// sequential write
+const size_t SELFPLAY_BUFFER_BYTES = (size_t)1 << 20;
+
+static void putU16(std::vector<uint8_t>& out, uint16_t value)
+{
+    out.push_back((uint8_t)value);
+    out.push_back((uint8_t)(value >> 8));
+}
+
+void encodeSelfPlayRecord(const SelfPlayRecord& record, int cellCount, std::vector<uint8_t>& out)
+{
+    putU16(out, (uint16_t)record.game);
+    putU16(out, (uint16_t)(record.game >> 16));
+    putU16(out, record.ply);
+    putU16(out, record.move);
+    putU16(out, (uint16_t)record.score);
+    out.push_back(record.depth);
+    out.push_back((uint8_t)record.result);
+
+    size_t board = out.size();
+    out.resize(board + (cellCount + 3) / 4, 0);
+    for (int cell = 0; cell < cellCount; cell++)
+    {
+        if (record.cells[cell] != -1)
+            out[board + cell / 4] |= (uint8_t)((record.cells[cell] + 1) << ((cell % 4) * 2));
+    }
+}
+
+void encodeSelfPlayHeader(const Hypergraph& graph, uint8_t* header)
+{
+    memcpy(header, SELFPLAY_MAGIC, 8);
+    header[8] = (uint8_t)graph.rows;
+    header[9] = (uint8_t)graph.cols;
+    header[10] = (uint8_t)graph.k;
+    header[11] = (uint8_t)graph.shape;
+    int recordSize = selfPlayRecordSize(graph.cellCount);
+    header[12] = (uint8_t)graph.cellCount;
+    header[13] = (uint8_t)(graph.cellCount >> 8);
+    header[14] = (uint8_t)recordSize;
+    header[15] = (uint8_t)(recordSize >> 8);
+}
+
+bool setupSelfPlay(const Options& options, const HypergraphRules& rules, SelfPlaySetup& setup)
+{
+    const Hypergraph& graph = rules.graph;
+    if (graph.rows > 255 || graph.cols > 255)
+    {
+        std::cout << "selfplay records boards of at most 255x255" << std::endl;
+        return false;
+    }
+
+    if (!parseEngineConfig(getOption(options, "engine", "d4:depth=4"), setup.engine))
+        return false;
+    // Records carry the game number as 32 bits
+    long long games = getIntOption(options, "games", 1000);
+    if (games < 1 || games > (long long)UINT32_MAX)
+    {
+        std::cout << "Expected --games between 1 and " << UINT32_MAX << std::endl;
+        return false;
+    }
+    setup.games = (uint64_t)games;
+    setup.openingPlies = (int)getIntOption(options, "opening-plies", 2);
+    setup.seed = (uint64_t)getIntOption(options, "seed", 1);
+    return true;
+}
+
+SelfPlayGenerator::SelfPlayGenerator(const HypergraphRules& rules, const SelfPlaySetup& setup)
+    : rules(rules), setup(setup), player(rules, setup.engine), moves(rules.maxMoves())
+{
+}
+
+int SelfPlayGenerator::playGame(uint64_t game, std::vector<uint8_t>& out, uint64_t& positions)
+{
+    int cellCount = rules.graph.cellCount;
+    HypergraphState state;
+    rules.reset(state);
+    player.newGame(setup.seed, game);
+
+    // A few random moves first so the games differ
+    Xoshiro128 rng;
+    seedRandom(rng, ~setup.seed, game);
+    for (int ply = 0; ply < setup.openingPlies && !rules.isTerminal(state); ply++)
+    {
+        int count = rules.generateMoves(state, &moves[0]);
+        rules.makeMove(state, moves[randomBelow(rng, count)]);
+    }
+
+    boards.clear();
+    records.clear();
+    while (!rules.isTerminal(state))
+    {
+        boards.insert(boards.end(), state.cells.begin(), state.cells.end());
+        int move = player.chooseMove(state);
+        const SearchResult& result = player.lastResult();
+
+        SelfPlayRecord record;
+        record.game = (uint32_t)game;
+        record.ply = (uint16_t)state.moveCount;
+        record.move = (uint16_t)move;
+        record.score = (int16_t)result.score;
+        record.depth = (uint8_t)result.depth;
+        record.result = 0;
+        record.cells = nullptr;
+        records.push_back(record);
+
+        rules.makeMove(state, move);
+    }
+
+    int status = rules.status(state);
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        SelfPlayRecord& record = records[i];
+        int toMove = record.ply & 1;
+        if (status == GAME_X_WINS)
+            record.result = toMove == 0 ? 1 : -1;
+        else if (status == GAME_O_WINS)
+            record.result = toMove == 1 ? 1 : -1;
+        record.cells = &boards[i * cellCount];
+        encodeSelfPlayRecord(record, cellCount, out);
+    }
+    positions += records.size();
+    return status;
+}
+
+SelfPlayWriter::~SelfPlayWriter()
+{
+    close();
+}
+
+bool SelfPlayWriter::open(const std::string& prefix, int shardCount, const HypergraphRules& rules,
+    const SelfPlaySetup& setup)
+{
+    uint8_t header[SELFPLAY_HEADER_SIZE];
+    encodeSelfPlayHeader(rules.graph, header);
+
+    for (int s = 0; s < shardCount; s++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "-%03d.bin", s);
+        shards.push_back(std::unique_ptr<Shard>(new Shard()));
+        shards[s]->file = fopen((prefix + name).c_str(), "wb");
+        if (shards[s]->file == nullptr || fwrite(header, 1, sizeof(header), shards[s]->file) != sizeof(header))
+        {
+            std::cout << "Cannot write " << prefix + name << std::endl;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void SelfPlayWriter::write(int shard, const uint8_t* data, size_t size)
+{
+    if (size == 0)
+        return;
+    Shard& target = *shards[shard % shards.size()];
+    std::lock_guard<std::mutex> lock(target.mutex);
+    if (fwrite(data, 1, size, target.file) != size)
+        failed = true;
+}
+
+bool SelfPlayWriter::close()
+{
+    for (size_t s = 0; s < shards.size(); s++)
+    {
+        if (shards[s]->file && fclose(shards[s]->file) != 0)
+            failed = true;
+        shards[s]->file = nullptr;
+    }
+    shards.clear();
+    return !failed;
+}
+
+void printSelfPlaySummary(const SelfPlayTotals& totals, int cellCount, int shardCount, double seconds)
+{
+    uint64_t bytes = totals.positions * selfPlayRecordSize(cellCount);
+    std::cout << "games: " << totals.games << " (x wins " << totals.outcomes[1] << ", o wins " << totals.outcomes[2]
+        << ", draws " << totals.outcomes[0] << ")" << std::endl;
+    std::cout << "positions: " << totals.positions << ", " << bytes / 1024 << " KiB in " << shardCount << " shards"
+        << std::endl;
+    std::cout << "time: " << (long long)(seconds * 1000) << " ms, games/s: "
+        << (long long)(seconds > 0 ? totals.games / seconds : 0) << ", positions/s: "
+        << (long long)(seconds > 0 ? totals.positions / seconds : 0) << std::endl;
+}
+
+int runSelfPlayCommand(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, 2, options))
+        return 1;
+
+    Hypergraph graph;
+    if (!makeGameFromOptions(options, graph))
+        return 1;
+    HypergraphRules rules(graph);
+    SelfPlaySetup setup;
+    if (!setupSelfPlay(options, rules, setup))
+        return 1;
+
+    TaskPool& pool = taskPoolFromOptions(options);
+    int shardCount = (int)getIntOption(options, "shards", pool.size());
+    if (shardCount < 1)
+        shardCount = 1;
+    std::string prefix = getOption(options, "out", "selfplay");
+
+    SelfPlayWriter writer;
+    if (!writer.open(prefix, shardCount, rules, setup))
+        return 1;
+
+    std::cout << "engine: " << describeEngineConfig(setup.engine) << ", games: " << setup.games << ", threads: "
+        << pool.describe() << ", output: " << prefix << "-NNN.bin x " << shardCount << std::endl;
+
+    // Per-worker generator and output buffer; each game is one task
+    struct Slot
+    {
+        std::unique_ptr<SelfPlayGenerator> generator;
+        std::vector<uint8_t> buffer;
+        uint64_t positions = 0;
+        uint64_t outcomes[3] = {0, 0, 0};
+    };
+    std::vector<Slot> slots(pool.size());
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    parallelFor(pool, 0, setup.games, 1, [&](uint64_t g)
+    {
+        int worker = pool.currentWorker();
+        Slot& slot = slots[worker];
+        if (!slot.generator)
+        {
+            slot.generator.reset(new SelfPlayGenerator(rules, setup));
+            slot.buffer.reserve(SELFPLAY_BUFFER_BYTES + selfPlayRecordSize(rules.graph.cellCount) * (size_t)rules.graph.cellCount);
+        }
+
+        int status = slot.generator->playGame(g, slot.buffer, slot.positions);
+        slot.outcomes[status == GAME_X_WINS ? 1 : status == GAME_O_WINS ? 2 : 0]++;
+        if (slot.buffer.size() >= SELFPLAY_BUFFER_BYTES)
+        {
+            writer.write(worker, slot.buffer.data(), slot.buffer.size());
+            slot.buffer.clear();
+        }
+    });
+
+    SelfPlayTotals totals;
+    totals.games = setup.games;
+    for (size_t t = 0; t < slots.size(); t++)
+    {
+        writer.write((int)t, slots[t].buffer.data(), slots[t].buffer.size());
+        totals.positions += slots[t].positions;
+        for (int i = 0; i < 3; i++)
+            totals.outcomes[i] += slots[t].outcomes[i];
+    }
+
+    bool written = writer.close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!written)
+    {
+        std::cout << "Writing the shards failed (disk full?)" << std::endl;
+        return 1;
+    }
+
+    printSelfPlaySummary(totals, rules.graph.cellCount, shardCount, seconds);
+    return 0;
+}
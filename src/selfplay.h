@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "match.h"
+#include "options.h"
+
+// Self-play training data. Each shard file starts with a header and is then
+// a flat array of fixed-size records, all little-endian:
+//
+//   header (16 bytes)
+//     char[8]  magic "TTTSELF1"
+//     uint8    rows, cols, k
+//     uint8    game: 0 grid, 1 torus, 2 hex (GameShape in hypergraph.h)
+//     uint16   cell count
+//     uint16   record size
+//
+//   record (12 + ceil(cells / 4) bytes), one per position the engine moved in
+//     uint32   game number (unique across shards)
+//     uint16   ply (moves played before this position)
+//     uint16   move chosen
+//     int16    search score, side to move
+//     uint8    search depth
+//     int8     game result for the side to move: 1 win, 0 draw, -1 loss
+//     uint8[]  board, 2 bits per cell (0 empty, 1 X, 2 O), cell 0 in the
+//              low bits of the first byte
+//
+// The side to move follows from the stone counts (X moves first).
+
+const char SELFPLAY_MAGIC[8] = {'T', 'T', 'T', 'S', 'E', 'L', 'F', '1'};
+const int SELFPLAY_HEADER_SIZE = 16;
+const int SELFPLAY_RECORD_FIXED_SIZE = 12;
+
+inline int selfPlayRecordSize(int cellCount)
+{
+    return SELFPLAY_RECORD_FIXED_SIZE + (cellCount + 3) / 4;
+}
+
+struct SelfPlayRecord
+{
+    uint32_t game;
+    uint16_t ply;
+    uint16_t move;
+    int16_t score;
+    uint8_t depth;
+    int8_t result;
+    const int8_t* cells;         // EMPTY_CELL, 0 or 1 per cell
+};
+
+// Appends one encoded record to `out`
+void encodeSelfPlayRecord(const SelfPlayRecord& record, int cellCount, std::vector<uint8_t>& out);
+
+void encodeSelfPlayHeader(const Hypergraph& graph, uint8_t* header);
+
+// What to play, from --engine, --games (at most 2^32 - 1, the range of the
+// recorded game number), --opening-plies and --seed. Game g is the same
+// wherever and whenever it is played.
+struct SelfPlaySetup
+{
+    EngineConfig engine;
+    uint64_t games = 0;
+    int openingPlies = 0;
+    uint64_t seed = 0;
+};
+
+// Returns false (after printing why) on bad options
+bool setupSelfPlay(const Options& options, const HypergraphRules& rules, SelfPlaySetup& setup);
+
+// Plays self-play games one after another. Keeps a MatchPlayer, so every
+// thread needs its own.
+class SelfPlayGenerator
+{
+public:
+    SelfPlayGenerator(const HypergraphRules& rules, const SelfPlaySetup& setup);
+
+    // Plays game `game`, appends one record per engine move to `out` and
+    // returns the GameStatus
+    int playGame(uint64_t game, std::vector<uint8_t>& out, uint64_t& positions);
+
+private:
+    const HypergraphRules& rules;
+    const SelfPlaySetup& setup;
+    MatchPlayer player;
+    std::vector<int> moves;
+    // The positions of the game in progress, kept until its result is known
+    std::vector<int8_t> boards;
+    std::vector<SelfPlayRecord> records;
+};
+
+// Shard files PREFIX-000.bin, PREFIX-001.bin, ..., each starting with the
+// header. Any thread may append to any shard.
+class SelfPlayWriter
+{
+public:
+    ~SelfPlayWriter();
+
+    // Returns false (after printing why) if a file cannot be created
+    bool open(const std::string& prefix, int shardCount, const HypergraphRules& rules, const SelfPlaySetup& setup);
+
+    void write(int shard, const uint8_t* data, size_t size);
+
+    // Returns false if any write failed (disk full?)
+    bool close();
+
+    int shardCount() const { return (int)shards.size(); }
+
+private:
+    struct Shard
+    {
+        FILE* file = nullptr;
+        std::mutex mutex;
+    };
+    std::vector<std::unique_ptr<Shard> > shards;
+    std::atomic<bool> failed{false};
+};
+
+struct SelfPlayTotals
+{
+    uint64_t games = 0;
+    uint64_t outcomes[3] = {0, 0, 0};   // draws, X wins, O wins
+    uint64_t positions = 0;
+};
+
+void printSelfPlaySummary(const SelfPlayTotals& totals, int cellCount, int shardCount, double seconds);
+
+// `tictactoe-cli selfplay ...`
+int runSelfPlayCommand(int argc, char** argv);
@@ -0,0 +1,15 @@
+#include "simd_kernels.h"
+
+#include "bitplane_kernel.h"
+#include "playout_kernel.h"
+#include "random_kernel.h"
+
+// Built with -mavx2 -mpopcnt (see CMakeLists.txt)
+const SimdKernels AVX2_KERNELS = {
+    SIMD_AVX2,
+    Avx2Lanes::LANES,
+    playoutLanes<Avx2Lanes>,
+    stepBatchAvx2,
+    hasWinWords<Avx2Words>,
+    countThreatsWords<Avx2Words>
+};
@@ -0,0 +1,15 @@
+#include "simd_kernels.h"
+
+#include "bitplane_kernel.h"
+#include "playout_kernel.h"
+#include "random_kernel.h"
+
+// Built with -mavx512f -mavx512bw -mpopcnt (see CMakeLists.txt)
+const SimdKernels AVX512_KERNELS = {
+    SIMD_AVX512,
+    Avx512Lanes::LANES,
+    playoutLanes<Avx512Lanes>,
+    stepBatchAvx512,
+    hasWinWords<Avx512Words>,
+    countThreatsWords<Avx512Words>
+};
@@ -0,0 +1,18 @@
+#include "simd_kernels.h"
+
+const SimdKernels& simdKernels()
+{
+    static const SimdKernels* const kernels[SIMD_LEVEL_COUNT] = {
+        &SCALAR_KERNELS,
+#if defined(TICTACTOE_X86_KERNELS)
+        &SSE42_KERNELS,
+        &AVX2_KERNELS,
+        &AVX512_KERNELS,
+#else
+        &SCALAR_KERNELS,
+        &SCALAR_KERNELS,
+        &SCALAR_KERNELS,
+#endif
+    };
+    return *kernels[activeSimdLevel()];
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include "bitplane.h"
+#include "cpu_features.h"
+#include "random.h"
+
+// Entry points of every SIMD kernel, one table per instruction set. Each
+// table lives in its own translation unit (simd_scalar.cpp, simd_sse42.cpp,
+// ...) compiled with that instruction set enabled; nothing else in the build
+// assumes more than the baseline.
+struct SimdKernels
+{
+    SimdLevel level;
+
+    // Random playouts on boards of up to 16 cells, playoutLanes games per call
+    // (see playout_kernel.h)
+    int playoutLanes;
+    void (*playout)(int cellCount, const uint16_t* winMasks, int lineCount, uint16_t xMask, uint16_t oMask,
+        int toMove, const uint16_t* random, uint16_t* winners);
+
+    // Advances all RANDOM_BATCH_LANES generators of a batch by one step
+    void (*randomStep)(RandomBatch& batch, uint32_t* out);
+
+    // Bit-plane scans (see bitplane_kernel.h)
+    bool (*bitPlanesHasWin)(const BitPlanes& planes, int player, int k);
+    int (*bitPlanesCountThreats)(const BitPlanes& planes, int player, int k);
+};
+
+extern const SimdKernels SCALAR_KERNELS;
+#if defined(TICTACTOE_X86_KERNELS)
+extern const SimdKernels SSE42_KERNELS;
+extern const SimdKernels AVX2_KERNELS;
+extern const SimdKernels AVX512_KERNELS;
+#endif
+
+// The table for activeSimdLevel()
+const SimdKernels& simdKernels();
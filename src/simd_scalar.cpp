@@ -0,0 +1,15 @@
+#include "simd_kernels.h"
+
+#include "bitplane_kernel.h"
+#include "playout_kernel.h"
+#include "random_kernel.h"
+
+// Plain integer kernels, built for the baseline target
+const SimdKernels SCALAR_KERNELS = {
+    SIMD_SCALAR,
+    ScalarLanes::LANES,
+    playoutLanes<ScalarLanes>,
+    stepBatchScalar,
+    hasWinWords<ScalarWords>,
+    countThreatsWords<ScalarWords>
+};
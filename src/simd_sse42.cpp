@@ -0,0 +1,15 @@
+#include "simd_kernels.h"
+
+#include "bitplane_kernel.h"
+#include "playout_kernel.h"
+#include "random_kernel.h"
+
+// Built with -msse4.2 -mpopcnt (see CMakeLists.txt)
+const SimdKernels SSE42_KERNELS = {
+    SIMD_SSE42,
+    Sse2Lanes::LANES,
+    playoutLanes<Sse2Lanes>,
+    stepBatchSse2,
+    hasWinWords<Sse42Words>,
+    countThreatsWords<Sse42Words>
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Capacity must be a power of two; one slot is always left free.
+template<class T, size_t Capacity>
+class SpscQueue
+{
+public:
+    SpscQueue() : head(0), tail(0)
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+    }
+
+    // Producer side. Returns false if the queue is full.
+    bool push(const T& value)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = (t + 1) & (Capacity - 1);
+        if (next == head.load(std::memory_order_acquire))
+            return false;
+        items[t] = value;
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool pop(T& value)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        value = items[h];
+        head.store((h + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[Capacity];
+    // Kept on separate cache lines so the two threads do not share one
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
@@ -0,0 +1,411 @@
+#include "task_pool.h"
+
+struct Task
+{
+    std::function<void()> body;
+    TaskGroup* group;
+};
+
+// Chase-Lev work-stealing deque ("Correct and Efficient Work-Stealing for
+// Weak Memory Models", Le et al. 2013). Only the owner calls push and pop;
+// any thread may steal. Outgrown arrays are kept until the deque goes away,
+// since a thief may still be reading one.
+class WorkDeque
+{
+public:
+    WorkDeque()
+    {
+        arrays.push_back(std::unique_ptr<Array>(new Array(64)));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    void push(Task* task)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+        if (b - t > a->mask)
+            a = grow(a, t, b);
+        a->put(b, task);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    Task* pop()
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        Task* task = nullptr;
+        if (t <= b)
+        {
+            task = a->get(b);
+            // Last task: race the thieves for it
+            if (t == b)
+            {
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    task = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        }
+        else
+            bottom.store(b + 1, std::memory_order_relaxed);
+        return task;
+    }
+
+    Task* steal()
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+
+        Task* task = array.load(std::memory_order_acquire)->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return task;
+    }
+
+private:
+    struct Array
+    {
+        explicit Array(int64_t capacity) : mask(capacity - 1), slots(new std::atomic<Task*>[capacity]) {}
+
+        // Acquire/release rather than relaxed so a thief sees the task it
+        // took fully built (free on x86)
+        Task* get(int64_t i) const { return slots[i & mask].load(std::memory_order_acquire); }
+        void put(int64_t i, Task* task) { slots[i & mask].store(task, std::memory_order_release); }
+
+        int64_t mask;
+        std::unique_ptr<std::atomic<Task*>[]> slots;
+    };
+
+    Array* grow(Array* old, int64_t t, int64_t b)
+    {
+        arrays.push_back(std::unique_ptr<Array>(new Array((old->mask + 1) * 2)));
+        Array* bigger = arrays.back().get();
+        for (int64_t i = t; i < b; i++)
+            bigger->put(i, old->get(i));
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    // Separate cache lines: the owner hammers bottom, thieves top
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    std::atomic<Array*> array{nullptr};
+    std::vector<std::unique_ptr<Array> > arrays;
+};
+
+struct TaskWorker
+{
+    WorkDeque deque;
+    // Steal from these in order: same NUMA node first, then the rest
+    std::vector<int> nearVictims, farVictims;
+    uint64_t victim = 0;         // rotates the starting point of each list
+};
+
+// Which pool (if any) the current thread works for
+static thread_local const TaskPool* workerPool = nullptr;
+static thread_local int workerIndex = -1;
+
+TaskPool::TaskPool(int threads, PinMode pin) : pinMode(pin)
+{
+    if (threads < 1)
+        threads = 1;
+    CpuTopology topology = detectCpuTopology();
+    nodeCount = (int)topology.nodes.size();
+    placement = planCpuPlacement(topology, threads, pin);
+
+    workers.resize(threads);
+    for (int i = 0; i < threads; i++)
+        this->threads.push_back(std::thread(&TaskPool::workerLoop, this, i));
+
+    std::unique_lock<std::mutex> lock(startMutex);
+    startCondition.wait(lock, [&]() { return started == threads; });
+}
+
+std::string TaskPool::describe() const
+{
+    std::string text = std::to_string(size());
+    if (pinMode == PIN_NONE)
+        return text + " (unpinned, " + std::to_string(nodeCount) + (nodeCount == 1 ? " NUMA node)" : " NUMA nodes)");
+
+    int used = 0;
+    for (int node = 0; node < nodeCount; node++)
+    {
+        for (size_t i = 0; i < placement.size(); i++)
+        {
+            if (placement[i].node == node)
+            {
+                used++;
+                break;
+            }
+        }
+    }
+    text += std::string(" (pinned ") + pinModeName(pinMode) + " over " + std::to_string(used)
+        + (used == 1 ? " NUMA node" : " NUMA nodes");
+    if (pinFailures > 0)
+        text += ", pinning failed for " + std::to_string(pinFailures.load()) + " workers";
+    return text + ")";
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(parkMutex);
+        stopping = true;
+        wakeups++;
+    }
+    parkCondition.notify_all();
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+}
+
+int TaskPool::currentWorker() const
+{
+    return workerPool == this ? workerIndex : -1;
+}
+
+void TaskPool::submit(Task* task)
+{
+    int self = currentWorker();
+    if (self >= 0)
+        workers[self]->deque.push(task);
+    else
+    {
+        std::lock_guard<std::mutex> lock(injectedMutex);
+        injected.push_back(task);
+        injectedCount++;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_seq_cst) > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            wakeups++;
+        }
+        parkCondition.notify_one();
+    }
+}
+
+Task* TaskPool::findTask(int self)
+{
+    if (self >= 0)
+    {
+        Task* task = workers[self]->deque.pop();
+        if (task)
+            return task;
+    }
+
+    if (injectedCount.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(injectedMutex);
+        if (!injected.empty())
+        {
+            // Oldest first, like a steal
+            Task* task = injected.front();
+            injected.pop_front();
+            injectedCount--;
+            return task;
+        }
+    }
+
+    if (self < 0)
+    {
+        for (int victim = 0; victim < size(); victim++)
+        {
+            Task* task = workers[victim]->deque.steal();
+            if (task)
+                return task;
+        }
+        return nullptr;
+    }
+
+    // Try every other worker once, nearest first, starting somewhere
+    // different each time
+    TaskWorker& worker = *workers[self];
+    uint64_t start = worker.victim++;
+    const std::vector<int>* lists[2] = {&worker.nearVictims, &worker.farVictims};
+    for (int l = 0; l < 2; l++)
+    {
+        const std::vector<int>& victims = *lists[l];
+        for (size_t i = 0; i < victims.size(); i++)
+        {
+            Task* task = workers[victims[(start + i) % victims.size()]]->deque.steal();
+            if (task)
+                return task;
+        }
+    }
+    return nullptr;
+}
+
+void TaskPool::execute(Task* task)
+{
+    task->body();
+    TaskGroup* group = task->group;
+    delete task;
+    group->finishOne();
+}
+
+void TaskPool::workerLoop(int index)
+{
+    workerPool = this;
+    workerIndex = index;
+
+    // Pin before allocating, so the deque is first touched on this node
+    if (placement[index].cpu >= 0 && !pinCurrentThread(placement[index].cpu))
+        pinFailures++;
+    TaskWorker* worker = new TaskWorker();
+    for (int other = 0; other < (int)placement.size(); other++)
+    {
+        if (other != index)
+            (placement[other].node == placement[index].node ? worker->nearVictims : worker->farVictims).push_back(other);
+    }
+    {
+        std::unique_lock<std::mutex> lock(startMutex);
+        workers[index].reset(worker);
+        started++;
+        startCondition.notify_all();
+        // Every deque must exist before anyone steals
+        startCondition.wait(lock, [&]() { return started == size(); });
+    }
+
+    while (!stopping)
+    {
+        Task* task = findTask(index);
+        if (task)
+        {
+            execute(task);
+            continue;
+        }
+
+        // A few cheap retries before parking: work often turns up right after
+        // a task finishes
+        for (int spin = 0; spin < 64 && !task; spin++)
+        {
+            std::this_thread::yield();
+            task = findTask(index);
+        }
+        if (task)
+        {
+            execute(task);
+            continue;
+        }
+
+        uint64_t seen = wakeups.load(std::memory_order_seq_cst);
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        task = findTask(index);
+        if (!task)
+        {
+            std::unique_lock<std::mutex> lock(parkMutex);
+            parkCondition.wait(lock, [&]() { return stopping || wakeups.load() != seen; });
+        }
+        sleepers.fetch_sub(1, std::memory_order_seq_cst);
+        if (task)
+            execute(task);
+    }
+}
+
+static std::mutex sharedPoolMutex;
+static std::unique_ptr<TaskPool> sharedPool;
+static int sharedPoolThreads = 0;
+static PinMode sharedPoolPin = PIN_NONE;
+
+TaskPool& sharedTaskPool()
+{
+    std::lock_guard<std::mutex> lock(sharedPoolMutex);
+    if (!sharedPool)
+    {
+        int threads = sharedPoolThreads > 0 ? sharedPoolThreads : (int)std::thread::hardware_concurrency();
+        sharedPool.reset(new TaskPool(threads, sharedPoolPin));
+    }
+    return *sharedPool;
+}
+
+bool setSharedTaskPoolConfig(int threads, PinMode pin)
+{
+    std::lock_guard<std::mutex> lock(sharedPoolMutex);
+    if (sharedPool)
+        return false;
+    sharedPoolThreads = threads;
+    sharedPoolPin = pin;
+    return true;
+}
+
+TaskGroup::TaskGroup(TaskPool& pool) : pool(pool)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    wait();
+}
+
+void TaskGroup::run(std::function<void()> body)
+{
+    pending++;
+    pool.submit(new Task{std::move(body), this});
+}
+
+// Counting down under the mutex means a waiter that saw zero and then took
+// the mutex knows no finisher still touches the group
+void TaskGroup::finishOne()
+{
+    std::lock_guard<std::mutex> lock(doneMutex);
+    if (--pending == 0)
+        doneCondition.notify_all();
+}
+
+void TaskGroup::wait()
+{
+    int self = pool.currentWorker();
+    if (self < 0)
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCondition.wait(lock, [&]() { return pending.load() == 0; });
+        return;
+    }
+
+    // Inside the pool: keep the worker busy until the group is done
+    while (pending.load() != 0)
+    {
+        Task* task = pool.findTask(self);
+        if (task)
+            pool.execute(task);
+        else
+            std::this_thread::yield();
+    }
+    std::lock_guard<std::mutex> lock(doneMutex);
+}
+
+static void splitRange(TaskGroup& group, uint64_t begin, uint64_t end, uint64_t grain,
+    const std::function<void(uint64_t)>& body)
+{
+    while (end - begin > grain)
+    {
+        uint64_t middle = begin + (end - begin) / 2;
+        group.run([&group, middle, end, grain, &body]() { splitRange(group, middle, end, grain, body); });
+        end = middle;
+    }
+    for (uint64_t i = begin; i < end; i++)
+        body(i);
+}
+
+void parallelFor(TaskPool& pool, uint64_t begin, uint64_t end, uint64_t grain,
+    const std::function<void(uint64_t)>& body)
+{
+    if (begin >= end)
+        return;
+    if (grain < 1)
+        grain = 1;
+
+    TaskGroup group(pool);
+    group.run([&]() { splitRange(group, begin, end, grain, body); });
+    group.wait();
+}
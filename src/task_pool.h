@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "affinity.h"
+
+class TaskGroup;
+struct Task;
+struct TaskWorker;
+
+// Fixed set of worker threads shared by every parallel command (perft,
+// census, self-play, tournaments, distributed workers). Each worker owns a
+// Chase-Lev deque: it pushes and pops its own tasks at the bottom (newest
+// first, so nested work stays cache-warm) while idle workers steal from the
+// top (oldest, usually the biggest pieces). Tasks submitted from outside the
+// pool go through a shared queue. Workers that find nothing park on a
+// condition variable instead of spinning.
+//
+// With pinning each worker is bound to one CPU before it allocates anything,
+// so its deque and whatever its tasks allocate in their per-worker slots
+// come from its own NUMA node, and idle workers steal from workers on the
+// same node before crossing to another.
+//
+// Long-lived loops that block waiting for requests (AiWorker, the engine's
+// search thread) keep their own threads; only finite work belongs here.
+class TaskPool
+{
+public:
+    explicit TaskPool(int threads, PinMode pin = PIN_NONE);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    int size() const { return (int)workers.size(); }
+
+    // Index of the calling thread in [0, size()) if it is one of this pool's
+    // workers, -1 otherwise. Tasks use it to pick per-worker scratch state.
+    int currentWorker() const;
+
+    // NUMA node (index into the detected topology) of a worker; 0 unpinned
+    int workerNode(int worker) const { return placement[worker].node; }
+
+    // For run summaries, e.g. "8 (pinned spread over 2 NUMA nodes)"
+    std::string describe() const;
+
+private:
+    friend class TaskGroup;
+
+    void submit(Task* task);
+    Task* findTask(int self);
+    void execute(Task* task);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<TaskWorker> > workers;
+    std::vector<std::thread> threads;
+
+    PinMode pinMode;
+    int nodeCount;
+    std::vector<CpuPlacement> placement;
+    std::atomic<int> pinFailures{0};
+
+    // Workers build their own TaskWorker after pinning; the constructor
+    // waits until all of them exist
+    std::mutex startMutex;
+    std::condition_variable startCondition;
+    int started = 0;
+
+    std::mutex injectedMutex;
+    std::deque<Task*> injected;
+    std::atomic<int> injectedCount{0};
+
+    // Parking: a worker registers as a sleeper, checks the queues once more
+    // and only then waits for `wakeups` to change. Submitters bump `wakeups`
+    // whenever someone might be asleep, so no wakeup is lost.
+    std::mutex parkMutex;
+    std::condition_variable parkCondition;
+    std::atomic<int> sleepers{0};
+    std::atomic<uint64_t> wakeups{0};
+    std::atomic<bool> stopping{false};
+};
+
+// The pool every command shares, started on first use with
+// setSharedTaskPoolConfig's values (default: one unpinned worker per
+// hardware thread)
+TaskPool& sharedTaskPool();
+
+// Returns false once the shared pool has already started
+bool setSharedTaskPoolConfig(int threads, PinMode pin);
+
+// Fork/join: run() queues tasks, wait() returns once all of them (and any
+// they queued on this group) have finished. A worker thread that waits
+// runs other tasks meanwhile, so groups can nest without deadlock.
+class TaskGroup
+{
+public:
+    explicit TaskGroup(TaskPool& pool);
+    ~TaskGroup();
+
+    void run(std::function<void()> body);
+    void wait();
+
+private:
+    friend class TaskPool;
+
+    void finishOne();
+
+    TaskPool& pool;
+    std::atomic<int64_t> pending{0};
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+};
+
+// Calls body(i) for every i in [begin, end) on the pool and waits. The range
+// is split in halves down to `grain` indices, so thieves take large pieces
+// and the owner works through the rest in order.
+void parallelFor(TaskPool& pool, uint64_t begin, uint64_t end, uint64_t grain,
+    const std::function<void(uint64_t)>& body);
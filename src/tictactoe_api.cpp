@@ -0,0 +1,225 @@
+#include "tictactoe_api.h"
+
+#include <new>
+#include "hypergraph.h"
+#include "playout.h"
+#include "search.h"
+#include "vector_env.h"
+
+static_assert(TTT_SCORE_WIN == SCORE_WIN && TTT_SCORE_WIN_BOUND == SCORE_WIN_BOUND, "scores must match search.h");
+static_assert(TTT_OUTCOME_X_WINS == (int)PLAYOUT_X_WINS && TTT_OUTCOME_O_WINS == (int)PLAYOUT_O_WINS, "outcomes must match playout.h");
+
+struct ttt_engine
+{
+    HypergraphRules rules;
+    AlphaBetaSearch<HypergraphRules> search;
+    PlayoutBoard playoutBoard;
+    HypergraphState state;
+
+    explicit ttt_engine(const Hypergraph& graph)
+        : rules(graph), search(rules, 18), playoutBoard(makePlayoutBoard(graph))
+    {
+    }
+};
+
+struct ttt_vec_env
+{
+    VectorEnv env;
+
+    ttt_vec_env(const Hypergraph& graph, int count, VectorEnvAgent agent, uint64_t seed)
+        : env(graph, count, agent, seed)
+    {
+    }
+};
+
+static_assert(TTT_AGENT_SELF_PLAY == (int)ENV_SELF_PLAY && TTT_AGENT_X == (int)ENV_AGENT_X && TTT_AGENT_O == (int)ENV_AGENT_O, "agents must match vector_env.h");
+static_assert(TTT_GAME_GRID == (int)SHAPE_GRID && TTT_GAME_TORUS == (int)SHAPE_TORUS && TTT_GAME_HEX == (int)SHAPE_HEX, "games must match hypergraph.h");
+
+// Score of a finished game for the side to move
+static int terminalScore(const HypergraphRules& rules, const HypergraphState& state)
+{
+    return rules.status(state) == GAME_DRAW ? 0 : -SCORE_WIN;
+}
+
+extern "C" {
+
+int ttt_api_version(void)
+{
+    return TTT_API_VERSION;
+}
+
+ttt_engine* ttt_create(int game, int rows, int cols, int k)
+{
+    Hypergraph graph;
+    if (!makeGame(game, rows, cols, k, graph))
+        return nullptr;
+
+    // Exceptions must not cross the C boundary
+    try
+    {
+        return new ttt_engine(graph);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void ttt_destroy(ttt_engine* engine)
+{
+    delete engine;
+}
+
+int ttt_cell_count(const ttt_engine* engine)
+{
+    return engine ? engine->rules.graph.cellCount : 0;
+}
+
+void ttt_clear(ttt_engine* engine)
+{
+    if (engine)
+        engine->search.clear();
+}
+
+int ttt_evaluate(ttt_engine* engine, const int8_t* boards, int count, int depth, int32_t* scores)
+{
+    if (!engine || count < 0 || depth < 0 || (count > 0 && (!boards || !scores)))
+        return TTT_ERROR_ARGUMENT;
+
+    const HypergraphRules& rules = engine->rules;
+    HypergraphState& state = engine->state;
+    int cellCount = rules.graph.cellCount;
+
+    SearchLimits limits;
+    limits.maxDepth = depth;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!rules.setPosition(state, boards + (size_t)i * cellCount))
+            return TTT_ERROR_POSITION;
+
+        if (rules.isTerminal(state))
+            scores[i] = terminalScore(rules, state);
+        else if (depth == 0)
+            scores[i] = rules.evaluate(state);
+        else
+            scores[i] = engine->search.search(state, limits).score;
+    }
+    return TTT_OK;
+}
+
+int ttt_best_moves(ttt_engine* engine, const int8_t* boards, int count, int depth, uint64_t nodes,
+    int32_t* moves, int32_t* scores)
+{
+    if (!engine || count < 0 || depth < 1 || (count > 0 && (!boards || !moves)))
+        return TTT_ERROR_ARGUMENT;
+
+    const HypergraphRules& rules = engine->rules;
+    HypergraphState& state = engine->state;
+    int cellCount = rules.graph.cellCount;
+
+    SearchLimits limits;
+    limits.maxDepth = depth;
+    limits.maxNodes = nodes;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!rules.setPosition(state, boards + (size_t)i * cellCount))
+            return TTT_ERROR_POSITION;
+
+        if (rules.isTerminal(state))
+        {
+            moves[i] = -1;
+            if (scores)
+                scores[i] = terminalScore(rules, state);
+            continue;
+        }
+
+        SearchResult result = engine->search.search(state, limits);
+        moves[i] = result.bestMove;
+        if (scores)
+            scores[i] = result.score;
+    }
+    return TTT_OK;
+}
+
+int ttt_play_random_games(ttt_engine* engine, const int8_t* board, uint64_t games, uint64_t seed,
+    uint8_t* outcomes, uint64_t* totals)
+{
+    if (!engine || !board)
+        return TTT_ERROR_ARGUMENT;
+    if (engine->playoutBoard.winMasks.empty())
+        return TTT_ERROR_UNSUPPORTED;
+
+    const HypergraphRules& rules = engine->rules;
+    HypergraphState& state = engine->state;
+    if (!rules.setPosition(state, board))
+        return TTT_ERROR_POSITION;
+
+    uint64_t masks[2] = {0, 0};
+    for (int cell = 0; cell < rules.graph.cellCount; cell++)
+    {
+        if (state.cells[cell] != EMPTY_CELL)
+            masks[state.cells[cell]] |= 1ULL << cell;
+    }
+
+    PlayoutResults results = playRandomGames(engine->playoutBoard, masks[0], masks[1], state.toMove, games, seed, outcomes);
+    if (totals)
+    {
+        totals[0] = results.draws;
+        totals[1] = results.xWins;
+        totals[2] = results.oWins;
+    }
+    return TTT_OK;
+}
+
+ttt_vec_env* ttt_vec_env_create(int game, int rows, int cols, int k, int count, int agent, uint64_t seed)
+{
+    Hypergraph graph;
+    if (count < 1 || agent < TTT_AGENT_SELF_PLAY || agent > TTT_AGENT_O || !makeGame(game, rows, cols, k, graph)
+        || (agent == TTT_AGENT_O && (k < 2 || graph.cellCount < 2)))
+        return nullptr;
+
+    try
+    {
+        return new ttt_vec_env(graph, count, (VectorEnvAgent)agent, seed);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void ttt_vec_env_destroy(ttt_vec_env* env)
+{
+    delete env;
+}
+
+int ttt_vec_env_size(const ttt_vec_env* env)
+{
+    return env ? env->env.size() : 0;
+}
+
+int ttt_vec_env_cell_count(const ttt_vec_env* env)
+{
+    return env ? env->env.cellCount() : 0;
+}
+
+int ttt_vec_env_reset(ttt_vec_env* env, int8_t* observations)
+{
+    if (!env || !observations)
+        return TTT_ERROR_ARGUMENT;
+    env->env.reset(observations);
+    return TTT_OK;
+}
+
+int ttt_vec_env_step(ttt_vec_env* env, const int32_t* actions, int8_t* observations, float* rewards,
+    uint8_t* dones, int8_t* final_observations)
+{
+    if (!env || !actions || !observations || !rewards || !dones)
+        return TTT_ERROR_ARGUMENT;
+    env->env.step(actions, observations, rewards, dones, final_observations);
+    return TTT_OK;
+}
+
+}
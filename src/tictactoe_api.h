@@ -0,0 +1,132 @@
+#ifndef TICTACTOE_API_H
+#define TICTACTOE_API_H
+
+/*
+ * C interface to the game engine, built as the shared library tictactoe_api
+ * for use from other languages through FFI.
+ *
+ * Boards are passed as one signed byte per cell (cell = row * cols + col):
+ * -1 empty, 0 X, 1 O. X moves first, so the side to move follows from the
+ * stone counts. Batch calls take `count` boards back to back, each
+ * ttt_cell_count() bytes long, so one call can cover many positions.
+ *
+ * All functions return TTT_OK or a negative TTT_ERROR_* code. A handle must
+ * not be used by two threads at once; create one handle per thread instead.
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(TICTACTOE_API_BUILD)
+#    define TTT_API __declspec(dllexport)
+#  else
+#    define TTT_API __declspec(dllimport)
+#  endif
+#else
+#  define TTT_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a signature or the meaning of a value changes */
+#define TTT_API_VERSION 1
+
+enum
+{
+    TTT_OK = 0,
+    TTT_ERROR_ARGUMENT = -1,     /* null pointer, bad size or unknown game */
+    TTT_ERROR_POSITION = -2,     /* a board that cannot arise in a game */
+    TTT_ERROR_UNSUPPORTED = -3   /* e.g. random games on more than 64 cells */
+};
+
+enum
+{
+    TTT_GAME_GRID = 0,
+    TTT_GAME_TORUS = 1,
+    TTT_GAME_HEX = 2
+};
+
+/* Random game results, as written by ttt_play_random_games */
+enum
+{
+    TTT_OUTCOME_DRAW = 0,
+    TTT_OUTCOME_X_WINS = 1,
+    TTT_OUTCOME_O_WINS = 2
+};
+
+/* Whose actions ttt_vec_env_step takes */
+enum
+{
+    TTT_AGENT_SELF_PLAY = -1,    /* both sides; each step rewards the side that moved */
+    TTT_AGENT_X = 0,             /* X, against a uniformly random O */
+    TTT_AGENT_O = 1              /* O, against a uniformly random X that opens */
+};
+
+/* Scores at or beyond +-TTT_SCORE_WIN_BOUND are forced results:
+ * TTT_SCORE_WIN - n is a win in n plies, -(TTT_SCORE_WIN - n) a loss */
+#define TTT_SCORE_WIN 30000
+#define TTT_SCORE_WIN_BOUND 29000
+
+typedef struct ttt_engine ttt_engine;
+typedef struct ttt_vec_env ttt_vec_env;
+
+TTT_API int ttt_api_version(void);
+
+/* k-in-a-row on a rows x cols board (k at most 255). Returns null on bad
+ * arguments. */
+TTT_API ttt_engine* ttt_create(int game, int rows, int cols, int k);
+TTT_API void ttt_destroy(ttt_engine* engine);
+
+TTT_API int ttt_cell_count(const ttt_engine* engine);
+
+/* Forgets everything the search has learned (its transposition table) */
+TTT_API void ttt_clear(ttt_engine* engine);
+
+/* Scores `count` positions from the side to move. depth 0 is the static
+ * evaluation; a larger depth searches that many plies. Finished games score
+ * 0 (draw) or -TTT_SCORE_WIN (the side to move has lost). */
+TTT_API int ttt_evaluate(ttt_engine* engine, const int8_t* boards, int count, int depth, int32_t* scores);
+
+/* Searches `count` positions to `depth` plies (and at most `nodes` nodes
+ * each if nonzero). Writes the chosen cell, or -1 for a finished game, and
+ * optionally its score. */
+TTT_API int ttt_best_moves(ttt_engine* engine, const int8_t* boards, int count, int depth, uint64_t nodes,
+    int32_t* moves, int32_t* scores);
+
+/* Plays `games` uniformly random games from one position (boards of up to
+ * 64 cells). `outcomes`, if not null, receives one TTT_OUTCOME_* per game;
+ * `totals`, if not null, receives the draw, X win and O win counts. Game i
+ * uses random stream (seed, i), so results are reproducible. */
+TTT_API int ttt_play_random_games(ttt_engine* engine, const int8_t* board, uint64_t games, uint64_t seed,
+    uint8_t* outcomes, uint64_t* totals);
+
+/* `count` games stepped together, for reinforcement learning (k at most
+ * 255). The state is kept as struct-of-arrays and every call covers all
+ * games, so the per-call overhead is paid once per batch rather than once
+ * per game. Large batches are spread over the shared worker threads. The
+ * opponent of game i draws from random stream (seed, i). With TTT_AGENT_O
+ * the opening move must not end the game (k >= 2, two cells or more). */
+TTT_API ttt_vec_env* ttt_vec_env_create(int game, int rows, int cols, int k, int count, int agent, uint64_t seed);
+TTT_API void ttt_vec_env_destroy(ttt_vec_env* env);
+
+TTT_API int ttt_vec_env_size(const ttt_vec_env* env);
+TTT_API int ttt_vec_env_cell_count(const ttt_vec_env* env);
+
+/* Starts every game over; `observations` receives size * cell count bytes */
+TTT_API int ttt_vec_env_reset(ttt_vec_env* env, int8_t* observations);
+
+/* Plays one cell per game (and the opponent's reply). Per game it writes
+ * the board, the reward (+1 win, -1 loss or illegal move, 0 otherwise) and
+ * done (1 if the game ended). Finished games restart at once, so their
+ * observation is the next game's first board; `final_observations`, if not
+ * null, receives the board each finished game ended on. */
+TTT_API int ttt_vec_env_step(ttt_vec_env* env, const int32_t* actions, int8_t* observations, float* rewards,
+    uint8_t* dones, int8_t* final_observations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
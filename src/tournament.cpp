@@ -0,0 +1,320 @@
+#include "tournament.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+
+static double eloFromScore(double score)
+{
+    if (score <= 0.0)
+        return -std::numeric_limits<double>::infinity();
+    if (score >= 1.0)
+        return std::numeric_limits<double>::infinity();
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+static double scoreFromElo(double elo)
+{
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// Mean and per-game variance of the score (win 1, draw 1/2, loss 0)
+static void scoreMoments(const MatchScore& score, double& mean, double& variance)
+{
+    double games = (double)(score.wins + score.draws + score.losses);
+    mean = (score.wins + 0.5 * score.draws) / games;
+    variance = (score.wins * (1.0 - mean) * (1.0 - mean) + score.draws * (0.5 - mean) * (0.5 - mean)
+        + score.losses * mean * mean) / games;
+}
+
+EloEstimate estimateElo(const MatchScore& score)
+{
+    EloEstimate estimate = {0.0, 0.0};
+    uint64_t games = score.wins + score.draws + score.losses;
+    if (games == 0)
+        return estimate;
+
+    double mean, variance;
+    scoreMoments(score, mean, variance);
+    double error = 1.96 * sqrt(variance / games);
+
+    estimate.elo = eloFromScore(mean);
+    double low = eloFromScore(mean - error), high = eloFromScore(mean + error);
+    estimate.margin = std::isfinite(low) && std::isfinite(high) ? (high - low) / 2 : std::numeric_limits<double>::infinity();
+    return estimate;
+}
+
+double sprtLlr(const MatchScore& score, double elo0, double elo1)
+{
+    uint64_t games = score.wins + score.draws + score.losses;
+    if (games == 0)
+        return 0.0;
+
+    double mean, variance;
+    scoreMoments(score, mean, variance);
+    // All games alike so far (e.g. all draws): no evidence either way yet
+    if (variance <= 0.0)
+        return 0.0;
+
+    double s0 = scoreFromElo(elo0), s1 = scoreFromElo(elo1);
+    return games * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+}
+
+static std::string formatElo(const EloEstimate& estimate)
+{
+    char text[64];
+    if (!std::isfinite(estimate.elo))
+        snprintf(text, sizeof(text), "%s", estimate.elo > 0 ? "+inf" : "-inf");
+    else if (!std::isfinite(estimate.margin))
+        snprintf(text, sizeof(text), "%+.1f +- inf", estimate.elo);
+    else
+        snprintf(text, sizeof(text), "%+.1f +- %.1f", estimate.elo, estimate.margin);
+    return text;
+}
+
+static void printScoreLine(const std::string& label, const MatchScore& score)
+{
+    uint64_t games = score.wins + score.draws + score.losses;
+    char line[160];
+    snprintf(line, sizeof(line), "%-24s %7llu %6llu %6llu %6llu %7.1f%%  %s", label.c_str(), (unsigned long long)games,
+        (unsigned long long)score.wins, (unsigned long long)score.draws, (unsigned long long)score.losses,
+        games ? 100.0 * (score.wins + 0.5 * score.draws) / games : 0.0, formatElo(estimateElo(score)).c_str());
+    std::cout << line << std::endl;
+}
+
+bool setupTournament(const Options& options, const HypergraphRules& rules, TournamentSetup& setup)
+{
+    std::stringstream specs(getOption(options, "engines", "d2:depth=2;d4:depth=4"));
+    std::string spec;
+    while (std::getline(specs, spec, ';'))
+    {
+        if (spec.empty())
+            continue;
+        EngineConfig config;
+        if (!parseEngineConfig(spec, config))
+            return false;
+        setup.engines.push_back(config);
+    }
+    if (setup.engines.size() < 2)
+    {
+        std::cout << "A tournament needs at least two engines" << std::endl;
+        return false;
+    }
+
+    // Round robin: every pair. Gauntlet: the first engine against each other.
+    setup.mode = getOption(options, "mode", "roundrobin");
+    for (int a = 0; a < (int)setup.engines.size(); a++)
+    {
+        for (int b = a + 1; b < (int)setup.engines.size(); b++)
+        {
+            if (setup.mode == "roundrobin" || a == 0)
+                setup.pairs.push_back(std::make_pair(a, b));
+        }
+    }
+    if (setup.mode != "roundrobin" && setup.mode != "gauntlet")
+    {
+        std::cout << "Unknown --mode " << setup.mode << " (expected roundrobin or gauntlet)" << std::endl;
+        return false;
+    }
+
+    setup.sprt = hasOption(options, "sprt");
+    double alpha = getDoubleOption(options, "alpha", 0.05), beta = getDoubleOption(options, "beta", 0.05);
+    if (setup.sprt)
+    {
+        if (sscanf(getOption(options, "sprt", "").c_str(), "%lf,%lf", &setup.elo0, &setup.elo1) != 2
+            || setup.pairs.size() != 1)
+        {
+            std::cout << "--sprt elo0,elo1 needs exactly two engines" << std::endl;
+            return false;
+        }
+    }
+    setup.lowerBound = log(beta / (1.0 - alpha));
+    setup.upperBound = log((1.0 - beta) / alpha);
+
+    setup.seed = (uint64_t)getIntOption(options, "seed", 1);
+    long long rounds = getIntOption(options, "rounds", 1);
+    long long openings = getIntOption(options, "openings", 50);
+    long long openingPlies = getIntOption(options, "opening-plies", 2);
+    long long balanceDepth = getIntOption(options, "balance-depth", 4);
+    int cells = rules.graph.cellCount;
+    if (rounds < 1 || rounds > 1000000 || openings < 1 || openings > 1000000 || openingPlies < 0
+        || openingPlies > cells || balanceDepth < 0 || balanceDepth > cells)
+    {
+        std::cout << "Expected --rounds and --openings from 1 to 1000000, and --opening-plies and --balance-depth from 0 to "
+            << cells << std::endl;
+        return false;
+    }
+    setup.rounds = (int)rounds;
+
+    setup.openings = generateOpenings(rules, (int)openings, (int)openingPlies, setup.seed, (int)balanceDepth,
+        (int)getIntOption(options, "balance-margin", 100));
+    if (setup.openings.empty())
+    {
+        std::cout << "No balanced openings found; try fewer --opening-plies or a larger --balance-margin" << std::endl;
+        return false;
+    }
+
+    setup.totalGames = (uint64_t)setup.pairs.size() * setup.openings.size() * 2 * setup.rounds;
+    return true;
+}
+
+void printTournamentSetup(const TournamentSetup& setup)
+{
+    std::cout << "engines:";
+    for (size_t e = 0; e < setup.engines.size(); e++)
+        std::cout << (e ? ", " : " ") << describeEngineConfig(setup.engines[e]);
+    std::cout << std::endl;
+    std::cout << "mode: " << setup.mode << ", openings: " << setup.openings.size() << " x 2 colours x " << setup.rounds
+        << " rounds, games: " << setup.totalGames << std::endl;
+}
+
+std::vector<std::unique_ptr<MatchPlayer> > makeTournamentPlayers(const HypergraphRules& rules,
+    const TournamentSetup& setup)
+{
+    std::vector<std::unique_ptr<MatchPlayer> > players;
+    for (size_t e = 0; e < setup.engines.size(); e++)
+        players.push_back(std::unique_ptr<MatchPlayer>(new MatchPlayer(rules, setup.engines[e])));
+    return players;
+}
+
+int playTournamentGame(const HypergraphRules& rules, const TournamentSetup& setup,
+    std::vector<std::unique_ptr<MatchPlayer> >& players, uint64_t g)
+{
+    size_t pair = g % setup.pairs.size();
+    uint64_t round = g / setup.pairs.size();
+    const HypergraphState& opening = setup.openings[(round / 2) % setup.openings.size()];
+    bool swapped = (round & 1) != 0;
+
+    MatchPlayer& first = *players[setup.pairs[pair].first];
+    MatchPlayer& second = *players[setup.pairs[pair].second];
+    MatchPlayer& x = swapped ? second : first;
+    MatchPlayer& o = swapped ? first : second;
+    x.newGame(setup.seed, 2 * g);
+    o.newGame(setup.seed, 2 * g + 1);
+    return playMatchGame(rules, opening, x, o);
+}
+
+bool recordTournamentGame(const TournamentSetup& setup, TournamentResults& results, uint64_t g, int status)
+{
+    if (results.pairScores.size() != setup.pairs.size())
+        results.pairScores.resize(setup.pairs.size());
+
+    size_t pair = g % setup.pairs.size();
+    bool swapped = ((g / setup.pairs.size()) & 1) != 0;
+    MatchScore& score = results.pairScores[pair];
+    if (status == GAME_DRAW)
+        score.draws++;
+    else if ((status == GAME_X_WINS) != swapped)
+        score.wins++;
+    else
+        score.losses++;
+    results.gamesPlayed++;
+
+    if (setup.sprt && results.sprtDecision == 0)
+    {
+        double llr = sprtLlr(score, setup.elo0, setup.elo1);
+        if (llr >= setup.upperBound || llr <= setup.lowerBound)
+            results.sprtDecision = llr >= setup.upperBound ? 1 : -1;
+    }
+    return results.sprtDecision != 0;
+}
+
+void printTournamentReport(const TournamentSetup& setup, const TournamentResults& results, double seconds)
+{
+    std::vector<MatchScore> pairScores = results.pairScores;
+    pairScores.resize(setup.pairs.size());
+
+    std::cout << std::endl;
+    char header[160];
+    snprintf(header, sizeof(header), "%-24s %7s %6s %6s %6s %8s  %s", "", "games", "wins", "draws", "losses", "score", "elo (95%)");
+    std::cout << header << std::endl;
+    for (size_t p = 0; p < setup.pairs.size(); p++)
+        printScoreLine(setup.engines[setup.pairs[p].first].name + " vs " + setup.engines[setup.pairs[p].second].name,
+            pairScores[p]);
+
+    // Each engine against the rest of the field
+    if (setup.pairs.size() > 1)
+    {
+        std::cout << std::endl;
+        for (size_t e = 0; e < setup.engines.size(); e++)
+        {
+            MatchScore total;
+            for (size_t p = 0; p < setup.pairs.size(); p++)
+            {
+                const MatchScore& score = pairScores[p];
+                if (setup.pairs[p].first == (int)e)
+                {
+                    total.wins += score.wins; total.draws += score.draws; total.losses += score.losses;
+                }
+                else if (setup.pairs[p].second == (int)e)
+                {
+                    total.wins += score.losses; total.draws += score.draws; total.losses += score.wins;
+                }
+            }
+            printScoreLine(setup.engines[e].name + " vs field", total);
+        }
+    }
+
+    if (setup.sprt)
+    {
+        double llr = sprtLlr(pairScores[0], setup.elo0, setup.elo1);
+        char line[200];
+        snprintf(line, sizeof(line), "SPRT elo0 %.1f, elo1 %.1f: LLR %.2f (bounds %.2f, %.2f) -> %s", setup.elo0,
+            setup.elo1, llr, setup.lowerBound, setup.upperBound,
+            results.sprtDecision > 0 ? "H1 accepted" : results.sprtDecision < 0 ? "H0 accepted" : "inconclusive");
+        std::cout << std::endl << line << std::endl;
+    }
+
+    std::cout << std::endl << "games: " << results.gamesPlayed << ", time: " << (long long)(seconds * 1000)
+        << " ms, games/s: " << (long long)(seconds > 0 ? results.gamesPlayed / seconds : 0) << std::endl;
+}
+
+int runTournamentCommand(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, 2, options))
+        return 1;
+
+    Hypergraph graph;
+    if (!makeGameFromOptions(options, graph))
+        return 1;
+    HypergraphRules rules(graph);
+    TournamentSetup setup;
+    if (!setupTournament(options, rules, setup))
+        return 1;
+
+    TaskPool& pool = taskPoolFromOptions(options);
+    printTournamentSetup(setup);
+    std::cout << "threads: " << pool.describe() << std::endl;
+
+    TournamentResults results;
+    std::mutex resultMutex;
+    std::atomic<bool> stop(false);
+
+    // One set of players per pool worker; each game is one task
+    std::vector<std::vector<std::unique_ptr<MatchPlayer> > > players(pool.size());
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    parallelFor(pool, 0, setup.totalGames, 1, [&](uint64_t g)
+    {
+        if (stop)
+            return;
+        std::vector<std::unique_ptr<MatchPlayer> >& own = players[pool.currentWorker()];
+        if (own.empty())
+            own = makeTournamentPlayers(rules, setup);
+        int status = playTournamentGame(rules, setup, own, g);
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if (!stop && recordTournamentGame(setup, results, g, status))
+            stop = true;
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printTournamentReport(setup, results, seconds);
+    return 0;
+}
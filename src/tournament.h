@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "match.h"
+#include "options.h"
+
+// Wins, draws and losses from one side's point of view
+struct MatchScore
+{
+    uint64_t wins = 0;
+    uint64_t draws = 0;
+    uint64_t losses = 0;
+};
+
+struct EloEstimate
+{
+    double elo;        // +-infinity after a clean sweep
+    double margin;     // half-width of the 95% interval
+};
+
+// Logistic Elo difference from the score, with the error bar from the
+// per-game score variance (games treated as independent)
+EloEstimate estimateElo(const MatchScore& score);
+
+// Log-likelihood ratio of H1 (difference elo1) against H0 (difference elo0),
+// using the normal approximation to the score distribution. Stop for H1 once
+// it reaches log((1 - beta) / alpha), for H0 once it drops below
+// log(beta / (1 - alpha)).
+double sprtLlr(const MatchScore& score, double elo0, double elo1);
+
+// Engines, pairings and openings from the tournament options. Game g is the
+// same wherever and whenever it is played: pair g % pairs, then each opening
+// twice with colours swapped. Interleaving the pairs keeps partial results
+// (and SPRT) fair.
+struct TournamentSetup
+{
+    std::vector<EngineConfig> engines;
+    std::vector<std::pair<int, int> > pairs;
+    std::vector<HypergraphState> openings;
+    std::string mode;
+    int rounds = 1;
+    uint64_t seed = 0;
+    uint64_t totalGames = 0;
+
+    bool sprt = false;
+    double elo0 = 0.0, elo1 = 5.0;
+    double lowerBound = 0.0, upperBound = 0.0;
+};
+
+// Returns false (after printing why) on bad options
+bool setupTournament(const Options& options, const HypergraphRules& rules, TournamentSetup& setup);
+
+void printTournamentSetup(const TournamentSetup& setup);
+
+// One MatchPlayer per engine, for one thread
+std::vector<std::unique_ptr<MatchPlayer> > makeTournamentPlayers(const HypergraphRules& rules,
+    const TournamentSetup& setup);
+
+// Plays game g and returns the GameStatus
+int playTournamentGame(const HypergraphRules& rules, const TournamentSetup& setup,
+    std::vector<std::unique_ptr<MatchPlayer> >& players, uint64_t g);
+
+struct TournamentResults
+{
+    std::vector<MatchScore> pairScores;
+    uint64_t gamesPlayed = 0;
+    int sprtDecision = 0;   // 1 = H1 accepted, -1 = H0 accepted
+};
+
+// Counts game g. Returns true once the SPRT has decided and no more games
+// are needed.
+bool recordTournamentGame(const TournamentSetup& setup, TournamentResults& results, uint64_t g, int status);
+
+void printTournamentReport(const TournamentSetup& setup, const TournamentResults& results, double seconds);
+
+// `tictactoe-cli tournament ...`
+int runTournamentCommand(int argc, char** argv);
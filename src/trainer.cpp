@@ -0,0 +1,258 @@
+#include "trainer.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include "options.h"
+#include "task_pool.h"
+
+void SharedPatternWeights::load(const PatternWeights& patterns)
+{
+    for (int i = 0; i < PATTERN_TABLE_SIZE; i++)
+        weights[i].store(patterns.weights[i], std::memory_order_relaxed);
+}
+
+PatternWeights SharedPatternWeights::snapshot() const
+{
+    PatternWeights patterns;
+    for (int i = 0; i < PATTERN_TABLE_SIZE; i++)
+        patterns.weights[i] = get(i);
+    return patterns;
+}
+
+TdTrainer::TdTrainer(const HypergraphRules& rules, SharedPatternWeights& shared, const TrainerSettings& settings)
+    : rules(rules), shared(shared), settings(settings), moves(rules.maxMoves())
+{
+    rules.reset(state);
+}
+
+float TdTrainer::value(const HypergraphState& position) const
+{
+    return tanhf(patternValue(weights, position.lines, rules.graph, position.toMove));
+}
+
+float TdTrainer::moverValue(const HypergraphState& position) const
+{
+    if (rules.isTerminal(position))
+        return rules.status(position) == GAME_DRAW ? 0.0f : 1.0f;
+    return -value(position);
+}
+
+TrainerGameStats TdTrainer::playGame(uint64_t game)
+{
+    const Hypergraph& graph = rules.graph;
+    uint32_t randomThreshold = (uint32_t)(settings.epsilon * 65536.0f);
+    float step = graph.lineCount > 0 ? settings.learningRate / graph.lineCount : 0.0f;
+
+    TrainerGameStats stats;
+    rules.reset(state);
+    seedRandom(rng, settings.seed, game);
+
+    while (!rules.isTerminal(state))
+    {
+        for (int i = 0; i < PATTERN_TABLE_SIZE; i++)
+            weights[i] = shared.get(i);
+
+        // Patterns of the position moved from, for the update below
+        memset(patternCounts, 0, sizeof(patternCounts));
+        int player = state.toMove;
+        for (int line = 0; line < graph.lineCount; line++)
+            patternCounts[patternIndex(state.lines.counts[player][line], state.lines.counts[1 - player][line])]++;
+        float before = value(state);
+
+        int count = rules.generateMoves(state, &moves[0]);
+        int move;
+        if ((uint32_t)randomBelow(rng, 65536) < randomThreshold)
+            move = moves[randomBelow(rng, count)];
+        else
+        {
+            // Greedy, with ties broken by where the scan starts
+            int first = randomBelow(rng, count);
+            float best = -2.0f;
+            move = moves[first];
+            for (int i = 0; i < count; i++)
+            {
+                int candidate = moves[(first + i) % count];
+                rules.makeMove(state, candidate);
+                float score = moverValue(state);
+                rules.unmakeMove(state, candidate);
+                if (score > best)
+                {
+                    best = score;
+                    move = candidate;
+                }
+            }
+        }
+
+        rules.makeMove(state, move);
+        float target = moverValue(state);
+        float error = target - before;
+        stats.tdErrorSum += fabsf(error);
+        stats.plies++;
+
+        // Gradient of tanh(mean weight) for each pattern is
+        // (1 - value^2) * count / lineCount
+        float delta = step * error * (1.0f - before * before);
+        for (int i = 0; i < PATTERN_TABLE_SIZE; i++)
+        {
+            if (patternCounts[i] != 0)
+                shared.add(i, delta * patternCounts[i]);
+        }
+    }
+
+    stats.status = rules.status(state);
+    return stats;
+}
+
+// Root mean square change of the weights between two snapshots
+static double weightChange(const PatternWeights& before, const PatternWeights& after)
+{
+    double sum = 0;
+    for (int i = 0; i < PATTERN_TABLE_SIZE; i++)
+    {
+        double difference = after.weights[i] - before.weights[i];
+        sum += difference * difference;
+    }
+    return sqrt(sum / PATTERN_TABLE_SIZE);
+}
+
+int runTrainCommand(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, 2, options))
+        return 1;
+
+    Hypergraph graph;
+    if (!makeGameFromOptions(options, graph))
+        return 1;
+    HypergraphRules rules(graph);
+    TrainerSettings settings;
+    settings.learningRate = (float)getDoubleOption(options, "alpha", 0.1);
+    settings.epsilon = (float)getDoubleOption(options, "epsilon", 0.1);
+    settings.seed = (uint64_t)getIntOption(options, "seed", 1);
+    long long games = getIntOption(options, "games", 100000);
+    long long reportEvery = getIntOption(options, "report", games / 20 > 0 ? games / 20 : 1);
+    long long snapshotEvery = getIntOption(options, "snapshot-every", games / 10 > 0 ? games / 10 : 1);
+    std::string outPath = getOption(options, "out", "patterns.txt");
+    std::string curvePath = getOption(options, "curve", "");
+    if (games < 1 || reportEvery < 1 || snapshotEvery < 1 || settings.learningRate <= 0.0f
+        || settings.epsilon < 0.0f || settings.epsilon > 1.0f)
+    {
+        std::cout << "Expected --games, --report and --snapshot-every >= 1, --alpha > 0 and --epsilon in [0, 1]"
+            << std::endl;
+        return 1;
+    }
+
+    PatternWeights initial;
+    if (hasOption(options, "init") && !loadPatternWeights(getOption(options, "init", ""), initial))
+    {
+        std::cout << "Cannot read pattern weights from " << getOption(options, "init", "") << std::endl;
+        return 1;
+    }
+    std::unique_ptr<SharedPatternWeights> shared(new SharedPatternWeights());
+    shared->load(initial);
+
+    std::ofstream curve;
+    if (!curvePath.empty())
+    {
+        curve.open(curvePath);
+        if (!curve)
+        {
+            std::cout << "Cannot write " << curvePath << std::endl;
+            return 1;
+        }
+        curve << "games,seconds,games_per_second,td_error,x_wins,o_wins,draws,plies,weight_change" << std::endl;
+    }
+
+    TaskPool& pool = taskPoolFromOptions(options);
+    std::cout << "games: " << games << ", alpha: " << settings.learningRate << ", epsilon: " << settings.epsilon
+        << ", threads: " << pool.describe() << ", snapshots: " << outPath << " every " << snapshotEvery << " games"
+        << std::endl;
+
+    // Per-worker trainer and statistics since the last report
+    struct Slot
+    {
+        std::unique_ptr<TdTrainer> trainer;
+        uint64_t outcomes[3] = {0, 0, 0};
+        uint64_t plies = 0;
+        double tdErrorSum = 0;
+    };
+    std::vector<Slot> slots(pool.size());
+
+    char line[160];
+    snprintf(line, sizeof(line), "%10s %10s %9s %7s %7s %7s %6s %12s", "games", "games/s", "td-error", "x-wins",
+        "o-wins", "draws", "plies", "weight-rms");
+    std::cout << line << std::endl;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point windowStart = start;
+    PatternWeights previous = shared->snapshot();
+    for (long long done = 0; done < games;)
+    {
+        long long end = done + reportEvery < games ? done + reportEvery : games;
+        parallelFor(pool, done, end, 16, [&](uint64_t g)
+        {
+            Slot& slot = slots[pool.currentWorker()];
+            if (!slot.trainer)
+                slot.trainer.reset(new TdTrainer(rules, *shared, settings));
+
+            TrainerGameStats stats = slot.trainer->playGame(g);
+            slot.outcomes[stats.status == GAME_X_WINS ? 1 : stats.status == GAME_O_WINS ? 2 : 0]++;
+            slot.plies += stats.plies;
+            slot.tdErrorSum += stats.tdErrorSum;
+        });
+
+        uint64_t outcomes[3] = {0, 0, 0};
+        uint64_t plies = 0;
+        double tdErrorSum = 0;
+        for (size_t t = 0; t < slots.size(); t++)
+        {
+            for (int i = 0; i < 3; i++)
+                outcomes[i] += slots[t].outcomes[i];
+            plies += slots[t].plies;
+            tdErrorSum += slots[t].tdErrorSum;
+            slots[t] = Slot{std::move(slots[t].trainer)};
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double windowSeconds = std::chrono::duration<double>(now - windowStart).count();
+        double seconds = std::chrono::duration<double>(now - start).count();
+        windowStart = now;
+
+        long long windowGames = end - done;
+        PatternWeights current = shared->snapshot();
+        double change = weightChange(previous, current);
+        previous = current;
+        double gamesPerSecond = windowSeconds > 0 ? windowGames / windowSeconds : 0;
+        double tdError = plies ? tdErrorSum / plies : 0;
+
+        snprintf(line, sizeof(line), "%10lld %10.0f %9.4f %6.1f%% %6.1f%% %6.1f%% %6.2f %12.3g", end, gamesPerSecond,
+            tdError, 100.0 * outcomes[1] / windowGames, 100.0 * outcomes[2] / windowGames,
+            100.0 * outcomes[0] / windowGames, (double)plies / windowGames, change);
+        std::cout << line << std::endl;
+        if (curve.is_open())
+        {
+            curve << end << "," << seconds << "," << gamesPerSecond << "," << tdError << "," << outcomes[1] << ","
+                << outcomes[2] << "," << outcomes[0] << "," << plies << "," << change << std::endl;
+        }
+
+        if (end / snapshotEvery != done / snapshotEvery || end == games)
+        {
+            if (!savePatternWeights(outPath, current))
+            {
+                std::cout << "Cannot write " << outPath << std::endl;
+                return 1;
+            }
+        }
+        done = end;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "time: " << (long long)(seconds * 1000) << " ms, games/s: " << (long long)(seconds > 0 ? games / seconds : 0)
+        << ", weights: " << outPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "patterns.h"
+#include "random.h"
+#include "rules.h"
+
+// TD(0) learning of PatternWeights from self-play. The value of a position
+// for the side to move is tanh(patternValue(...)). Each game follows an
+// epsilon-greedy one-ply policy over the current weights, and after every
+// move the value of the position moved from is nudged towards the negated
+// value of the position reached (or towards the result once the game is
+// over), so no games have to be stored or exported.
+struct TrainerSettings
+{
+    float learningRate = 0.1f;
+    float epsilon = 0.1f;        // share of uniformly random moves
+    uint64_t seed = 1;
+};
+
+// The weights all workers train at once without locks (Hogwild). Reads and
+// writes are relaxed atomics, so two workers updating the same weight may
+// lose one of the updates; with small steps spread over many games that
+// costs far less than synchronising every move would.
+class SharedPatternWeights
+{
+public:
+    void load(const PatternWeights& patterns);
+    PatternWeights snapshot() const;
+
+    float get(int index) const { return weights[index].load(std::memory_order_relaxed); }
+    void add(int index, float delta) { weights[index].store(get(index) + delta, std::memory_order_relaxed); }
+
+private:
+    std::atomic<float> weights[PATTERN_TABLE_SIZE];
+};
+
+struct TrainerGameStats
+{
+    int status = GAME_ONGOING;
+    int plies = 0;
+    double tdErrorSum = 0;       // sum of |target - value| over the plies
+};
+
+// Plays training games for one worker thread
+class TdTrainer
+{
+public:
+    TdTrainer(const HypergraphRules& rules, SharedPatternWeights& shared, const TrainerSettings& settings);
+
+    // Plays game number `game` (random stream (seed, game)), updating the
+    // shared weights after every move
+    TrainerGameStats playGame(uint64_t game);
+
+private:
+    // Value for the side to move under the local copy of the weights
+    float value(const HypergraphState& position) const;
+    // Value of the move just played, for the player who made it
+    float moverValue(const HypergraphState& position) const;
+
+    const HypergraphRules& rules;
+    SharedPatternWeights& shared;
+    TrainerSettings settings;
+    float weights[PATTERN_TABLE_SIZE];   // read once per move from `shared`
+    int patternCounts[PATTERN_TABLE_SIZE];
+    HypergraphState state;
+    std::vector<int> moves;
+    Xoshiro128 rng;
+};
+
+// `tictactoe-cli train ...`
+int runTrainCommand(int argc, char** argv);
@@ -0,0 +1,217 @@
+#include "vector_env.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include "options.h"
+#include "task_pool.h"
+
+// Games per task when a step is spread over the task pool. Smaller batches
+// are stepped on the calling thread: a step is far cheaper than a task.
+const int VECTOR_ENV_CHUNK = 2048;
+
+VectorEnv::VectorEnv(const Hypergraph& graph, int envCount, VectorEnvAgent agent, uint64_t seed)
+    : graph(graph), envCount(envCount), agent(agent),
+      cells((size_t)envCount * graph.cellCount, EMPTY_CELL), toMove(envCount, 0), moveCount(envCount, 0),
+      rngs(envCount)
+{
+    for (int line = 0; line < graph.lineCount; line++)
+        lineLengths.push_back((uint8_t)lineLength(graph, line));
+    for (int p = 0; p < 2; p++)
+        lineStones[p].assign((size_t)envCount * graph.lineCount, 0);
+    for (int env = 0; env < envCount; env++)
+        seedRandom(rngs[env], seed, env);
+    for (int env = 0; env < envCount; env++)
+        resetGame(env);
+}
+
+void VectorEnv::resetGame(int env)
+{
+    memset(&cells[(size_t)env * graph.cellCount], EMPTY_CELL, graph.cellCount);
+    for (int p = 0; p < 2; p++)
+        memset(&lineStones[p][(size_t)env * graph.lineCount], 0, graph.lineCount);
+    toMove[env] = 0;
+    moveCount[env] = 0;
+
+    // The opponent opens when the agent is O
+    if (agent == ENV_AGENT_O)
+        play(env, randomEmptyCell(env));
+}
+
+bool VectorEnv::play(int env, int cell)
+{
+    int player = toMove[env];
+    cells[(size_t)env * graph.cellCount + cell] = (int8_t)player;
+    toMove[env] = (uint8_t)(1 - player);
+    moveCount[env]++;
+
+    uint8_t* stones = &lineStones[player][(size_t)env * graph.lineCount];
+    bool won = false;
+    for (int i = graph.cellStart[cell]; i < graph.cellStart[cell + 1]; i++)
+    {
+        int line = graph.cellLines[i];
+        if (++stones[line] == lineLengths[line])
+            won = true;
+    }
+    return won;
+}
+
+int VectorEnv::randomEmptyCell(int env)
+{
+    const int8_t* board = &cells[(size_t)env * graph.cellCount];
+    int pick = randomBelow(rngs[env], graph.cellCount - moveCount[env]);
+    for (int cell = 0;; cell++)
+    {
+        if (board[cell] == EMPTY_CELL && pick-- == 0)
+            return cell;
+    }
+}
+
+void VectorEnv::reset(int8_t* observations)
+{
+    for (int env = 0; env < envCount; env++)
+        resetGame(env);
+    memcpy(observations, cells.data(), cells.size());
+}
+
+void VectorEnv::stepRange(int first, int last, const int32_t* actions, int8_t* observations, float* rewards,
+    uint8_t* dones, int8_t* finalObservations)
+{
+    int cellCount = graph.cellCount;
+    for (int env = first; env < last; env++)
+    {
+        int8_t* board = &cells[(size_t)env * cellCount];
+        int action = actions[env];
+        float reward = 0.0f;
+        bool done = true;
+
+        if (action < 0 || action >= cellCount || board[action] != EMPTY_CELL)
+            reward = -1.0f;
+        else if (play(env, action))
+            reward = 1.0f;
+        else if (moveCount[env] == cellCount)
+            reward = 0.0f;
+        else if (agent == ENV_SELF_PLAY)
+            done = false;
+        else if (play(env, randomEmptyCell(env)))
+            reward = -1.0f;
+        else
+            done = moveCount[env] == cellCount;
+
+        if (done)
+        {
+            if (finalObservations)
+                memcpy(finalObservations + (size_t)env * cellCount, board, cellCount);
+            resetGame(env);
+        }
+        memcpy(observations + (size_t)env * cellCount, board, cellCount);
+        rewards[env] = reward;
+        dones[env] = done ? 1 : 0;
+    }
+}
+
+void VectorEnv::step(const int32_t* actions, int8_t* observations, float* rewards, uint8_t* dones,
+    int8_t* finalObservations)
+{
+    if (envCount < 2 * VECTOR_ENV_CHUNK)
+    {
+        stepRange(0, envCount, actions, observations, rewards, dones, finalObservations);
+        return;
+    }
+
+    // Games never share state, so chunks can go to any worker
+    int chunks = (envCount + VECTOR_ENV_CHUNK - 1) / VECTOR_ENV_CHUNK;
+    parallelFor(sharedTaskPool(), 0, chunks, 1, [&](uint64_t chunk)
+    {
+        int first = (int)chunk * VECTOR_ENV_CHUNK;
+        int last = first + VECTOR_ENV_CHUNK < envCount ? first + VECTOR_ENV_CHUNK : envCount;
+        stepRange(first, last, actions, observations, rewards, dones, finalObservations);
+    });
+}
+
+int runVectorEnvCommand(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, 2, options))
+        return 1;
+
+    Hypergraph graph;
+    if (!makeGameFromOptions(options, graph))
+        return 1;
+    int envCount = (int)getIntOption(options, "envs", 4096);
+    uint64_t steps = (uint64_t)getIntOption(options, "steps", 1000);
+    uint64_t seed = (uint64_t)getIntOption(options, "seed", 1);
+    std::string agentText = getOption(options, "agent", "x");
+    VectorEnvAgent agent = agentText == "o" ? ENV_AGENT_O : agentText == "self" ? ENV_SELF_PLAY : ENV_AGENT_X;
+    if (envCount < 1 || (agentText != "x" && agentText != "o" && agentText != "self"))
+    {
+        std::cout << "Expected --envs N >= 1 and --agent x|o|self" << std::endl;
+        return 1;
+    }
+    for (int line = 0; line < graph.lineCount; line++)
+    {
+        if (lineLength(graph, line) > 255)
+        {
+            std::cout << "vecenv supports lines of at most 255 cells" << std::endl;
+            return 1;
+        }
+        if (agent == ENV_AGENT_O && lineLength(graph, line) < 2)
+        {
+            std::cout << "--agent o needs k >= 2: X's opening move would end the game" << std::endl;
+            return 1;
+        }
+    }
+    if (agent == ENV_AGENT_O && graph.cellCount < 2)
+    {
+        std::cout << "--agent o needs at least two cells" << std::endl;
+        return 1;
+    }
+
+    TaskPool& pool = taskPoolFromOptions(options);
+    VectorEnv env(graph, envCount, agent, seed);
+    int cellCount = graph.cellCount;
+    std::vector<int8_t> observations((size_t)envCount * cellCount);
+    std::vector<float> rewards(envCount);
+    std::vector<uint8_t> dones(envCount);
+    std::vector<int32_t> actions(envCount);
+    env.reset(&observations[0]);
+
+    // The "policy" picks a random empty cell, so every action is legal and
+    // the time is the environment's, not an agent's
+    Xoshiro128 rng;
+    seedRandom(rng, seed, ~(uint64_t)0);
+    uint64_t episodes = 0;
+    double rewardSum = 0;
+    double policySeconds = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint64_t s = 0; s < steps; s++)
+    {
+        std::chrono::steady_clock::time_point policyStart = std::chrono::steady_clock::now();
+        for (int e = 0; e < envCount; e++)
+        {
+            const int8_t* board = &observations[(size_t)e * cellCount];
+            int cell = randomBelow(rng, cellCount);
+            while (board[cell] != EMPTY_CELL)
+                cell = cell + 1 == cellCount ? 0 : cell + 1;
+            actions[e] = cell;
+        }
+        policySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - policyStart).count();
+
+        env.step(&actions[0], &observations[0], &rewards[0], &dones[0], nullptr);
+        for (int e = 0; e < envCount; e++)
+        {
+            episodes += dones[e];
+            rewardSum += rewards[e];
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - policySeconds;
+
+    uint64_t totalSteps = steps * envCount;
+    std::cout << "envs: " << envCount << ", agent: " << agentText << ", threads: " << pool.describe() << std::endl;
+    std::cout << "steps: " << totalSteps << ", episodes: " << episodes << ", mean reward per episode: "
+        << (episodes ? rewardSum / episodes : 0.0) << std::endl;
+    std::cout << "step time: " << (long long)(seconds * 1000) << " ms, steps/s: "
+        << (long long)(seconds > 0 ? totalSteps / seconds : 0) << std::endl;
+    return 0;
+}
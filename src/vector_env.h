@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "hypergraph.h"
+#include "random.h"
+#include "rules.h"
+
+// Who the actions passed to VectorEnv::step are for
+enum VectorEnvAgent
+{
+    ENV_SELF_PLAY = -1,   // every step is the side to move's, rewarded for it
+    ENV_AGENT_X = 0,      // the agent plays X against a random opponent
+    ENV_AGENT_O = 1       // the agent plays O against a random opponent
+};
+
+// Many independent games stepped together, for reinforcement learning in
+// the style of a Gym vector environment. The state is struct-of-arrays: one
+// flat array per field, with per-cell and per-line fields in one block per
+// game, so a step touches a few contiguous rows instead of chasing objects.
+// Wins are found from per-line stone counts, updated only for the lines
+// through the cell just played.
+//
+// Games end on a win or a full board, like resetGame() in the window, and
+// restart as soon as they end (auto-reset): the observation returned for a
+// finished game is already the first one of its next game.
+class VectorEnv
+{
+public:
+    // Games of `graph`, whose lines must have at most 255 cells. With
+    // ENV_AGENT_O the opponent's opening move must not end the game.
+    VectorEnv(const Hypergraph& graph, int envCount, VectorEnvAgent agent, uint64_t seed);
+
+    int size() const { return envCount; }
+    int cellCount() const { return graph.cellCount; }
+
+    // Restarts every game. `observations` receives size() * cellCount()
+    // cells (-1 empty, 0 X, 1 O), game after game.
+    void reset(int8_t* observations);
+
+    // Plays actions[i] (a cell) in game i, then the opponent's reply. Each
+    // game writes its observation, its reward (+1 win, -1 loss or illegal
+    // move, 0 otherwise) and done (1 if the game ended this step). If
+    // `finalObservations` is not null, finished games also leave their last
+    // board there before the auto-reset.
+    void step(const int32_t* actions, int8_t* observations, float* rewards, uint8_t* dones, int8_t* finalObservations);
+
+private:
+    void resetGame(int env);
+    // Returns true if the move completed a line
+    bool play(int env, int cell);
+    int randomEmptyCell(int env);
+    void stepRange(int first, int last, const int32_t* actions, int8_t* observations, float* rewards,
+        uint8_t* dones, int8_t* finalObservations);
+
+    Hypergraph graph;
+    int envCount;
+    VectorEnvAgent agent;
+    std::vector<uint8_t> lineLengths;
+
+    std::vector<int8_t> cells;            // envCount x cellCount
+    std::vector<uint8_t> lineStones[2];   // envCount x lineCount, per player
+    std::vector<uint8_t> toMove;
+    std::vector<uint16_t> moveCount;
+    std::vector<Xoshiro128> rngs;         // the random opponent, stream (seed, env)
+};
+
+// `tictactoe-cli vecenv ...`: steps random actions and reports steps/s
+int runVectorEnvCommand(int argc, char** argv);